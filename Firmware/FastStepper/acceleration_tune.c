@@ -0,0 +1,268 @@
+#include "acceleration_tune.h"
+#include "stepper_motor.h"
+#include "encoder_supervisor.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Phases of the routine
+enum AutotuneState {AUTOTUNE_IDLE, AUTOTUNE_MOVING_OUT, AUTOTUNE_MOVING_BACK};
+
+// Flag indicating the trial movements are running
+bool autotune_is_running = false;
+
+// Flag indicating the last routine ended with results
+bool autotune_is_done = false;
+
+// Flag indicating the last routine couldn't find any safe parameters
+bool autotune_failed = false;
+
+// Trial movement distance (steps)
+int32_t autotune_distance = 2000;
+
+// First acceleration tested (steps/s^2)
+float autotune_initial_acceleration = 1000;
+
+// Position error that fails a trial (steps)
+int32_t autotune_tolerance = 4;
+
+// Margin removed from the highest safe parameters (%)
+int32_t autotune_margin = 20;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+enum AutotuneState autotune_state = AUTOTUNE_IDLE;
+
+// Flag indicating the maximum velocity is being tuned, after the acceleration
+bool autotune_tuning_velocity;
+
+uint8_t autotune_trials;
+
+// Flag indicating the routine must end as soon as the motor stops
+bool autotune_abort_requested = false;
+
+// Parameters in use when the routine started, restored at the end
+MotionProfile autotune_original_profile;
+bool autotune_original_correction;
+
+// Parameters of the current trial and of the last one that passed
+MotionProfile autotune_trial_profile;
+MotionProfile autotune_safe_profile;
+
+// Position the trial movements start from and come back to
+int32_t autotune_start_position;
+
+// Tuned parameters
+int32_t autotune_result[3];
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern bool motor_is_running;
+extern bool supervisor_is_enabled;
+extern bool supervisor_corrects;
+extern bool supervisor_stalled;
+extern float move_peak_velocity;
+
+bool autotune_set_config(int32_t distance, int32_t initial_acceleration, int32_t tolerance, int32_t margin)
+{
+	if (distance == 0 || initial_acceleration <= 0 || tolerance <= 0 || margin < 0 || margin > 90) return false;
+	
+	autotune_distance = distance;
+	autotune_initial_acceleration = initial_acceleration;
+	autotune_tolerance = tolerance;
+	autotune_margin = margin;
+	
+	return true;
+}
+
+// Start the next trial movement, from the start position to the far end
+static void autotune_start_trial(void)
+{
+	set_motion_profile(&autotune_trial_profile);
+	autotune_state = AUTOTUNE_MOVING_OUT;
+	move_to_target_position(autotune_start_position + autotune_distance);
+}
+
+// Acceleration and jerk of the trial scaled together, so the shape of the profile doesn't change
+static void autotune_scale_acceleration(float factor)
+{
+	autotune_trial_profile.acceleration *= factor;
+	autotune_trial_profile.deceleration *= factor;
+	autotune_trial_profile.acceleration_jerk *= factor;
+	autotune_trial_profile.deceleration_jerk *= factor;
+}
+
+bool autotune_start(void)
+{
+	// The encoder is the only way to know when the motor stalls
+	if (autotune_is_running || motor_is_running || supervisor_is_enabled == false) return false;
+	
+	get_motion_profile(&autotune_original_profile);
+	autotune_original_correction = supervisor_corrects;
+	
+	// The trials must show the missed steps, not correct them
+	supervisor_enable(true, false);
+	
+	// Start with the initial acceleration, keeping the ratios between the acceleration and the other parameters
+	autotune_trial_profile = autotune_original_profile;
+	autotune_scale_acceleration(autotune_initial_acceleration / autotune_original_profile.acceleration);
+	autotune_safe_profile = autotune_trial_profile;
+	
+	autotune_start_position = get_motor_position();
+	autotune_tuning_velocity = false;
+	autotune_trials = 0;
+	autotune_is_done = false;
+	autotune_failed = false;
+	autotune_abort_requested = false;
+	autotune_is_running = true;
+	
+	autotune_start_trial();
+	return true;
+}
+
+// Leave the routine, restoring the parameters the user had
+static void autotune_finish(void)
+{
+	autotune_is_running = false;
+	autotune_abort_requested = false;
+	autotune_state = AUTOTUNE_IDLE;
+	set_motion_profile(&autotune_original_profile);
+	supervisor_enable(true, autotune_original_correction);
+}
+
+void autotune_abort(void)
+{
+	if (autotune_is_running == false) return;
+	
+	// The parameters are restored on the main loop, once the motor stops
+	autotune_abort_requested = true;
+	quick_stop_motor();
+}
+
+// Go on to the next trial after one passed, or end the phase if there is nothing else to increase
+static bool autotune_next_trial(void)
+{
+	autotune_safe_profile = autotune_trial_profile;
+	
+	if (++autotune_trials >= AUTOTUNE_MAX_TRIALS) return false;
+	
+	if (autotune_tuning_velocity)
+	{
+		// The trial distance is too short to reach a higher velocity
+		if (move_peak_velocity < autotune_trial_profile.maximum_velocity * 0.95) return false;
+		if (autotune_trial_profile.maximum_velocity * AUTOTUNE_INCREASE > 65535) return false;
+		autotune_trial_profile.maximum_velocity = autotune_trial_profile.maximum_velocity * AUTOTUNE_INCREASE;
+	}
+	else
+	{
+		autotune_scale_acceleration(AUTOTUNE_INCREASE);
+	}
+	
+	autotune_start_trial();
+	return true;
+}
+
+// Ends the current phase, returns true if the whole routine is over
+static bool autotune_end_phase(bool any_trial_passed)
+{
+	if (autotune_tuning_velocity == false)
+	{
+		if (any_trial_passed == false)
+		{
+			autotune_failed = true;
+			return true;
+		}
+		
+		// Tune the velocity with the safe acceleration, margin included
+		float factor = (100 - autotune_margin) / 100.0;
+		autotune_trial_profile = autotune_safe_profile;
+		autotune_trial_profile.acceleration *= factor;
+		autotune_trial_profile.deceleration *= factor;
+		autotune_trial_profile.acceleration_jerk *= factor;
+		autotune_trial_profile.deceleration_jerk *= factor;
+		autotune_safe_profile = autotune_trial_profile;
+		autotune_tuning_velocity = true;
+		autotune_trials = 0;
+		autotune_start_trial();
+		return false;
+	}
+	
+	autotune_result[0] = (int32_t)autotune_safe_profile.acceleration;
+	autotune_result[1] = (int32_t)(autotune_safe_profile.maximum_velocity * (100 - autotune_margin) / 100);
+	autotune_result[2] = (int32_t)autotune_safe_profile.acceleration_jerk;
+	autotune_is_done = true;
+	return true;
+}
+
+bool autotune_update(void)
+{
+	if (autotune_is_running == false) return false;
+	
+	if (autotune_abort_requested)
+	{
+		if (motor_is_running) return false;
+		autotune_finish();
+		return true;
+	}
+	
+	int32_t error = supervisor_get_following_error();
+	if (error < 0) error = -error;
+	bool trial_failed = supervisor_stalled;
+	
+	if (motor_is_running)
+	{
+		// Stop right away, a stalled motor doesn't follow the steps anyway
+		if (trial_failed == false) return false;
+		stop_motor();
+	}
+	else
+	{
+		if (error >= autotune_tolerance) trial_failed = true;
+	}
+	
+	if (trial_failed)
+	{
+		// Steps were missed, so the position is taken from the encoder before going on
+		set_motor_position(get_motor_position() - supervisor_get_following_error());
+		supervisor_reset();
+		
+		bool any_trial_passed = (autotune_trials > 0);
+		if (autotune_end_phase(any_trial_passed))
+		{
+			autotune_finish();
+			return true;
+		}
+		return false;
+	}
+	
+	if (autotune_state == AUTOTUNE_MOVING_OUT)
+	{
+		autotune_state = AUTOTUNE_MOVING_BACK;
+		move_to_target_position(autotune_start_position);
+		return false;
+	}
+	
+	// Both movements of the trial passed
+	if (autotune_next_trial()) return false;
+	
+	if (autotune_end_phase(true))
+	{
+		autotune_finish();
+		return true;
+	}
+	return false;
+}
+
+void autotune_get_result(int32_t *result)
+{
+	result[0] = autotune_result[0];
+	result[1] = autotune_result[1];
+	result[2] = autotune_result[2];
+}
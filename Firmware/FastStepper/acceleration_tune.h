@@ -0,0 +1,36 @@
+#ifndef _ACCELERATION_TUNE_H_
+#define _ACCELERATION_TUNE_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Factor applied to the tested parameter after each successful trial
+#define AUTOTUNE_INCREASE 1.25
+
+// Maximum number of trials on each phase
+#define AUTOTUNE_MAX_TRIALS 16
+
+// Set the trial movement distance (steps), the first acceleration tested (steps/s^2),
+// the position error that fails a trial (steps) and the margin removed from the results (%)
+bool autotune_set_config(int32_t distance, int32_t initial_acceleration, int32_t tolerance, int32_t margin);
+
+// Start the trial movements from the current position (needs the encoder supervisor enabled)
+bool autotune_start(void);
+
+// Stop the trial movements and restore the motion parameters once the motor stops (safe to call from an interrupt)
+void autotune_abort(void);
+
+// Check the current trial and start the next one, returns true when the routine ends (called every ms)
+bool autotune_update(void);
+
+// Get the tuned acceleration (steps/s^2), maximum velocity (steps/s) and acceleration jerk (steps/s^3)
+void autotune_get_result(int32_t *result);
+
+#endif /* _ACCELERATION_TUNE_H_ */
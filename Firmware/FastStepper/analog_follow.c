@@ -0,0 +1,122 @@
+#include "analog_follow.h"
+#include "stepper_motor.h"
+#include "app_ios_and_regs.h"
+
+#include "math.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Mode the analog input was followed with on the last update
+enum AnalogFollowMode analog_follow_mode = ANALOG_FOLLOW_OFF;
+
+// Reading that corresponds to zero (ADC counts)
+int16_t analog_follow_center = 0;
+
+// Readings closer to the center than this are ignored (ADC counts)
+int16_t analog_follow_deadband = 20;
+
+// Steps/s or steps per ADC count
+float analog_follow_gain = 1.0;
+
+// Weight of each new reading on the filtered value
+float analog_follow_filter = 0.25;
+
+// Target position for a zero reading in the position mode (steps)
+int32_t analog_follow_position_offset = 0;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Filtered analog input (ADC counts)
+float analog_follow_filtered_input = 0;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern float motor_deceleration;
+extern bool jog_is_active;
+extern uint16_t motor_maximum_velocity;
+extern AppRegs app_regs;
+extern uint16_t temporary_reg_control;
+
+bool analog_follow_set_config(int32_t center, int32_t deadband, int32_t gain, int32_t filter, int32_t position_offset)
+{
+	if (center < -4095 || center > 4095) return false;
+	if (deadband < 0 || deadband > 2047) return false;
+	if (filter < 0 || filter > 7) return false;
+	
+	analog_follow_center = (int16_t)center;
+	analog_follow_deadband = (int16_t)deadband;
+	analog_follow_gain = gain * 0.001;
+	analog_follow_filter = 1.0 / (1 << filter);
+	analog_follow_position_offset = position_offset;
+	
+	return true;
+}
+
+void analog_follow_update(enum AnalogFollowMode mode, int16_t analog_input)
+{
+	if (mode == ANALOG_FOLLOW_OFF)
+	{
+		// Ramp down to a stop when leaving the following mode
+		if (analog_follow_mode != ANALOG_FOLLOW_OFF && jog_is_active) set_jog_velocity(0);
+		analog_follow_mode = ANALOG_FOLLOW_OFF;
+		return;
+	}
+	
+	// Start from the current reading so the filter doesn't cause a ramp when entering the mode
+	if (analog_follow_mode == ANALOG_FOLLOW_OFF) analog_follow_filtered_input = analog_input;
+	analog_follow_mode = mode;
+	
+	analog_follow_filtered_input += (analog_input - analog_follow_filtered_input) * analog_follow_filter;
+	
+	// Remove the deadband so the output starts from zero at its edges
+	float input = analog_follow_filtered_input - analog_follow_center;
+	if (input > analog_follow_deadband) input -= analog_follow_deadband;
+	else if (input < -analog_follow_deadband) input += analog_follow_deadband;
+	else input = 0;
+	
+	float velocity;
+	
+	if (mode == ANALOG_FOLLOW_VELOCITY)
+	{
+		velocity = input * analog_follow_gain;
+	}
+	else
+	{
+		float error = analog_follow_position_offset + input * analog_follow_gain - get_motor_position();
+		float distance = fabs(error);
+		
+		// Approach the target no faster than what still allows decelerating to a stop on it
+		float speed = ANALOG_FOLLOW_POSITION_GAIN * distance;
+		float braking_speed = sqrt(-2 * motor_deceleration * distance);
+		if (speed > braking_speed) speed = braking_speed;
+		
+		velocity = (error < 0) ? -speed : speed;
+	}
+	
+	if (velocity > motor_maximum_velocity) velocity = motor_maximum_velocity;
+	if (velocity < -(float)motor_maximum_velocity) velocity = -(float)motor_maximum_velocity;
+	
+	// The jog ramp applies the acceleration and jerk limits
+	set_jog_velocity((int32_t)velocity);
+}
+
+void analog_follow_disable(void)
+{
+	// Like the streamed setpoints and the gearing, a stop ends the mode instead of pausing it
+	// REG_CONTROL is copied from temporary_reg_control after a write, so both are changed
+	temporary_reg_control &= ~(REG_CONTROL_B_ENABLE_ANALOG_VELOCITY | REG_CONTROL_B_ENABLE_ANALOG_POSITION);
+	temporary_reg_control |= REG_CONTROL_B_DISABLE_ANALOG_FOLLOW;
+	app_regs.REG_CONTROL &= ~(REG_CONTROL_B_ENABLE_ANALOG_VELOCITY | REG_CONTROL_B_ENABLE_ANALOG_POSITION);
+	app_regs.REG_CONTROL |= REG_CONTROL_B_DISABLE_ANALOG_FOLLOW;
+	
+	// The motor is already stopping, so there is no ramp down to request
+	analog_follow_mode = ANALOG_FOLLOW_OFF;
+}
@@ -0,0 +1,35 @@
+#ifndef _ANALOG_FOLLOW_H_
+#define _ANALOG_FOLLOW_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// What the analog input controls
+enum AnalogFollowMode {ANALOG_FOLLOW_OFF, ANALOG_FOLLOW_VELOCITY, ANALOG_FOLLOW_POSITION};
+
+// Gain applied to the position error to get the velocity in the position mode (1/s)
+#define ANALOG_FOLLOW_POSITION_GAIN 20.0
+
+// Set how the analog input is mapped
+// center: reading that corresponds to zero (ADC counts)
+// deadband: readings closer to the center than this are ignored (ADC counts)
+// gain: steps/s (velocity mode) or steps (position mode) per ADC count, in 1/1000 units
+// filter: strength of the low pass filter applied to the readings, from 0 (none) to 7
+// position_offset: target position for a zero reading in the position mode (steps)
+bool analog_follow_set_config(int32_t center, int32_t deadband, int32_t gain, int32_t filter, int32_t position_offset);
+
+// Follow the analog input in the given mode, called from the main loop every 500 us
+void analog_follow_update(enum AnalogFollowMode mode, int16_t analog_input);
+
+// Leave the following mode after a stop command or the stop switch, until the host enables it again on REG_CONTROL
+// Called from the main loop, since it changes REG_CONTROL
+void analog_follow_disable(void);
+
+#endif /* _ANALOG_FOLLOW_H_ */
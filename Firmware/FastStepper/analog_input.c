@@ -1,47 +1,109 @@
 #include "analog_input.h"
 #include "cpu.h"
 
-#define F_CPU 32000000
-#include <util/delay.h>
-
 int16_t AdcOffset;
 
+// Flag indicating AdcOffset holds a calibrated or a known value
+bool adc_offset_is_known = false;
+
+// The ADC offset is read in the background, once the ADC settles
+enum AdcOffsetCalibration {ADC_OFFSET_SETTLING, ADC_OFFSET_READING, ADC_OFFSET_DONE};
+enum AdcOffsetCalibration adc_offset_calibration = ADC_OFFSET_SETTLING;
+
+// Calls left until the ADC settles, then number of readings taken
+uint16_t adc_offset_counter;
+
+// Last reading and how many times in a row it was read
+uint16_t adc_offset_previous_reading;
+uint8_t adc_offset_equal_readings;
+
+// Sum of the readings, used if they never settle
+uint32_t adc_offset_sum;
+
 void init_analog_input (void)
 {
-	uint16_t adc[ADC_OFFSET_CONSECUTIVE_EQUAL_READINGS];
-	
 	/* Initialize ADCA with single ended input */
 	adc_A_initialize_single_ended(ADC_REFSEL_INTVCC_gc);		// VCC/1.6 = 3.3/1.6 = 2.0625 V
 	ADCA_CH0_INTCTRL |= ADC_CH_INTLVL_LO_gc;						// Enable ADC0 interrupt
-	_delay_ms(100);
 	
-	/* Save ADC offset */
-	bool reading_adc_offset = true;
-		
-	ADCA_CH0_MUXCTRL = 2 << 3;											// Select pin 2	
-	do
+	/* The ADC offset is saved by update_adc_offset_calibration() */
+	adc_offset_calibration = ADC_OFFSET_SETTLING;
+	adc_offset_counter = ADC_OFFSET_SETTLING_CALLS;
+};
+
+static void start_adc_offset_conversion (void)
+{
+	ADCA_CH0_MUXCTRL = 2 << 3;				// Select pin 2
+	ADCA_CH0_CTRL |= ADC_CH_START_bm;	// Start conversion
+}
+
+bool update_adc_offset_calibration (void)
+{
+	switch (adc_offset_calibration)
 	{
-		for (uint8_t i = 0; i < ADC_OFFSET_CONSECUTIVE_EQUAL_READINGS; i++)
-		{
-			ADCA_CH0_CTRL |= ADC_CH_START_bm;						// Start conversion
-			while(!(ADCA_CH0_INTFLAGS & ADC_CH_CHIF_bm));		// Wait for conversion to finish
-			ADCA_CH0_INTFLAGS = ADC_CH_CHIF_bm;						// Clear interrupt bit
-			adc[i] = ADCA_CH0_RES;										// Save offset
-		}
+		case ADC_OFFSET_SETTLING:
+			// A known offset can already be used while the ADC settles
+			if (--adc_offset_counter > 0) return adc_offset_is_known;
+			
+			// The readings are polled, so they are not reported as the analog input
+			ADCA_CH0_INTCTRL &= ~ADC_CH_INTLVL_gm;
+			adc_offset_equal_readings = 0;
+			adc_offset_sum = 0;
+			adc_offset_calibration = ADC_OFFSET_READING;
+			start_adc_offset_conversion();
+			return false;
 		
-		reading_adc_offset = false;
-		
-		for (uint8_t i = 0; i < ADC_OFFSET_CONSECUTIVE_EQUAL_READINGS-1; i++)
+		case ADC_OFFSET_READING:
 		{
-			if (adc[i] != adc[i+1])
+			if (!(ADCA_CH0_INTFLAGS & ADC_CH_CHIF_bm)) return false;		// Wait for conversion to finish
+			ADCA_CH0_INTFLAGS = ADC_CH_CHIF_bm;								// Clear interrupt bit
+			uint16_t reading = ADCA_CH0_RES;
+			
+			adc_offset_equal_readings = (adc_offset_counter > 0 && reading == adc_offset_previous_reading) ? adc_offset_equal_readings + 1 : 1;
+			adc_offset_previous_reading = reading;
+			adc_offset_sum += reading;
+			adc_offset_counter++;
+			
+			/* Save ADC offset */
+			if (adc_offset_equal_readings >= ADC_OFFSET_CONSECUTIVE_EQUAL_READINGS)
+			{
+				AdcOffset = reading;
+			}
+			else if (adc_offset_counter >= ADC_OFFSET_MAX_READINGS)
+			{
+				// A noisy input may never give the same reading enough times in a row
+				AdcOffset = adc_offset_sum / adc_offset_counter;
+			}
+			else
 			{
-				reading_adc_offset |= true;
+				start_adc_offset_conversion();
+				return false;
 			}
+			
+			adc_offset_is_known = true;
+			adc_offset_calibration = ADC_OFFSET_DONE;
+			ADCA_CH0_INTCTRL |= ADC_CH_INTLVL_LO_gc;						// Enable ADC0 interrupt
+			return true;
 		}
-	} while (reading_adc_offset);
+		
+		default:
+			return true;
+	}
+}
+
+void set_adc_offset (int16_t offset)
+{
+	// The calibration replaces it once it ends
+	if (adc_offset_calibration == ADC_OFFSET_DONE) return;
 	
-	AdcOffset = adc[0];	
-};
+	AdcOffset = offset;
+	adc_offset_is_known = true;
+}
+
+bool adc_offset_is_valid (void)
+{
+	return adc_offset_is_known;
+}
 
 
 void start_analog_conversion (void)
@@ -53,4 +115,4 @@ void start_analog_conversion (void)
 int16_t get_analog_input (void)
 {
 	return ((int16_t)(ADCA_CH0_RES & 0x0FFF)) - AdcOffset;
-}
\ No newline at end of file
+}
@@ -13,7 +13,23 @@
 
 #define ADC_OFFSET_CONSECUTIVE_EQUAL_READINGS 8
 
+// Readings after which the offset is taken as their average, if the readings never settled
+#define ADC_OFFSET_MAX_READINGS 256
+
+// Time given to the ADC to settle after the initialization (calls to update_adc_offset_calibration, 100 ms)
+#define ADC_OFFSET_SETTLING_CALLS 200
+
 void init_analog_input (void);
+
+// Take the next ADC offset reading, returns true if the ADC is free for the analog input (called every 500 us)
+bool update_adc_offset_calibration (void);
+
+// Use a known ADC offset until the calibration ends
+void set_adc_offset (int16_t offset);
+
+// Check if the ADC offset is known, since the analog input can't be read without it
+bool adc_offset_is_valid (void);
+
 void start_analog_conversion (void);
 int16_t get_analog_input (void);
 
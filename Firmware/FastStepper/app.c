@@ -9,6 +9,20 @@
 #include "analog_input.h"
 #include "encoder.h"
 #include "stepper_motor.h"
+#include "trace_capture.h"
+#include "move_triggers.h"
+#include "pvt_stream.h"
+#include "electronic_gearing.h"
+#include "analog_follow.h"
+#include "encoder_supervisor.h"
+#include "acceleration_tune.h"
+#include "homing.h"
+#include "emergency_stop.h"
+#include "position_compare.h"
+#include "waypoints.h"
+#include "sequencer.h"
+#include "eeprom_config.h"
+#include "binary_link.h"
 
 #define F_CPU 32000000
 #include <util/delay.h>
@@ -69,6 +83,34 @@ void core_callback_catastrophic_error_detected(void)
 /* User functions                                                       */
 /************************************************************************/
 /* Add your functions here or load external functions if needed */
+extern int32_t motor_current_position;
+extern bool motor_is_running;
+extern enum MovementStatus current_movement_status;
+
+void update_sample_frame(void)
+{
+	/* Snapshot the values updated by the step interrupts so they refer to the same instant */
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	int32_t position = motor_current_position;
+	int32_t velocity = get_motor_velocity();
+	int16_t encoder = get_quadrature_encoder();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	uint8_t status = 0;
+	if (motor_is_running) status |= REG_FRAME_STATUS_B_MOVING;
+	if (!read_STOP_SWITCH) status |= REG_FRAME_STATUS_B_STOP_SWITCH;
+	if (!read_HOME_SWITCH) status |= REG_FRAME_STATUS_B_HOME_SWITCH;
+	if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_MOTOR) status |= REG_FRAME_STATUS_B_MOTOR_ENABLED;
+	if (homing_get_phase() != HOMING_IDLE) status |= REG_FRAME_STATUS_B_HOMING;
+	
+	app_regs.REG_FRAME[REG_FRAME_POSITION] = position;
+	app_regs.REG_FRAME[REG_FRAME_ENCODER] = encoder;
+	app_regs.REG_FRAME[REG_FRAME_ANALOG_INPUT] = app_regs.REG_ANALOG_INPUT;
+	app_regs.REG_FRAME[REG_FRAME_VELOCITY] = velocity;
+	app_regs.REG_FRAME[REG_FRAME_STATUS] = status;
+}
 
 /************************************************************************/
 /* Initialization Callbacks                                             */
@@ -88,10 +130,17 @@ void core_callback_initialize_hardware(void)
 	/* Initialize ADC */
 	init_analog_input();
 	
+	/* Use the ADC offset, the motion profile and the move presets saved on the last run, so the device is ready right away */
+	eeprom_config_load();
+	
 	/* Initialize encoder */
 	init_quadrature_encoder();
 	
+	/* Initialize the hardware stop of the step pulses */
+	init_emergency_stop();
+	
 	/* Initialize serial with 100 KHz */
+	/* Used as a receive only binary command link (see binary_link.h) */
 	uint16_t BSEL = 19;
 	int8_t BSCALE = 0;
 		
@@ -110,6 +159,11 @@ extern float motor_deceleration;
 extern float motor_acceleration_jerk;
 extern float motor_deceleration_jerk;
 
+// Move presets, which may come from the EEPROM
+extern int32_t move_preset_targets[];
+extern uint8_t move_presets_relative;
+extern uint8_t trigger_preset;
+
 
 void core_callback_reset_registers(void)
 {
@@ -121,6 +175,7 @@ void core_callback_reset_registers(void)
 	app_regs.REG_ANALOG_INPUT = 0;
 	/* Motor specific registers */
 	app_regs.REG_STOP_SWITCH = 0;
+	app_regs.REG_STOP_LATENCY = 0;
 	app_regs.REG_MOTOR_BRAKE = 0;
 	app_regs.REG_MOVING = 0;
 	/* Direct motor control */
@@ -140,15 +195,148 @@ void core_callback_reset_registers(void)
 	app_regs.REG_HOME_STEPS_EVENTS = 0;
 	app_regs.REG_HOME_VELOCITY = 0;
 	app_regs.REG_HOME_SWITCH = 0;
+	app_regs.REG_HOMING_CONFIG[0] = 200;
+	for (uint8_t i = 1; i < 4; i++)
+		app_regs.REG_HOMING_CONFIG[i] = 0;
+	app_regs.REG_HOMING_PHASE = HOMING_IDLE;
+	for (uint8_t i = 0; i < 3; i++)
+		app_regs.REG_HOME_SWITCH_LATCH[i] = 0;
+	/* Synchronized sampling */
+	for (uint8_t i = 0; i < 5; i++)
+		app_regs.REG_FRAME[i] = 0;
+	app_regs.REG_FRAME_PERIOD = 0;
+	/* Trace capture */
+	app_regs.REG_TRACE_CONTROL = 0;
+	app_regs.REG_TRACE_SIGNALS = REG_TRACE_SIGNALS_B_STEP_TIME | REG_TRACE_SIGNALS_B_STEP_PERIOD;
+	app_regs.REG_TRACE_DECIMATION = 1;
+	app_regs.REG_TRACE_COUNT = 0;
+	app_regs.REG_TRACE_READ_INDEX = 0;
+	for (uint8_t i = 0; i < TRACE_DATA_BLOCK_WORDS; i++)
+		app_regs.REG_TRACE_DATA[i] = 0;
+	/* Position */
+	app_regs.REG_POSITION = 0;
+	app_regs.REG_POSITION_EVENT_PERIOD = 0;
+	/* Scheduled movement */
+	app_regs.REG_MOVE_AT[0] = 0;
+	app_regs.REG_MOVE_AT[1] = -1;
+	app_regs.REG_MOVE_AT[2] = 0;
+	app_regs.REG_MOVE_AT_ERROR = 0;
+	/* Triggered movement */
+	app_regs.REG_DIGITAL_INPUTS = 0;
+	app_regs.REG_TRIGGER_CONFIG = 0;
+	app_regs.REG_TRIGGER_MOVE_TO = 0;
+	/* Streamed movement */
+	for (uint8_t i = 0; i < 3; i++)
+		app_regs.REG_PVT_POINT[i] = 0;
+	app_regs.REG_PVT_CONTROL = 0;
+	app_regs.REG_PVT_FILL_LEVEL = 0;
+	/* Quick stop */
+	app_regs.REG_QUICK_STOP_DECELERATION = -20000;
+	app_regs.REG_QUICK_STOP_JERK = -400000;
+	/* Feed override */
+	app_regs.REG_FEED_OVERRIDE = 100;
+	/* Position limits */
+	app_regs.REG_POSITION_LIMITS[0] = -2147483647;
+	app_regs.REG_POSITION_LIMITS[1] = 2147483647;
+	app_regs.REG_POSITION_LIMIT_EVENTS = 0;
+	/* Electronic gearing */
+	app_regs.REG_GEAR_RATIO[0] = 1;
+	app_regs.REG_GEAR_RATIO[1] = 1;
+	app_regs.REG_GEARING_CONTROL = 0;
+	/* Analog following */
+	app_regs.REG_ANALOG_FOLLOW_CONFIG[0] = 0;
+	app_regs.REG_ANALOG_FOLLOW_CONFIG[1] = 20;
+	app_regs.REG_ANALOG_FOLLOW_CONFIG[2] = 1000;
+	app_regs.REG_ANALOG_FOLLOW_CONFIG[3] = 2;
+	app_regs.REG_ANALOG_FOLLOW_CONFIG[4] = 0;
+	/* Encoder supervisor */
+	app_regs.REG_SUPERVISOR_CONFIG[0] = 1;
+	app_regs.REG_SUPERVISOR_CONFIG[1] = 1;
+	app_regs.REG_SUPERVISOR_CONFIG[2] = 100;
+	app_regs.REG_SUPERVISOR_CONTROL = 0;
+	app_regs.REG_FOLLOWING_ERROR = 0;
+	/* Acceleration auto-tune */
+	app_regs.REG_AUTOTUNE_CONFIG[0] = 2000;
+	app_regs.REG_AUTOTUNE_CONFIG[1] = 1000;
+	app_regs.REG_AUTOTUNE_CONFIG[2] = 4;
+	app_regs.REG_AUTOTUNE_CONFIG[3] = 20;
+	app_regs.REG_AUTOTUNE_CONTROL = 0;
+	for (uint8_t i = 0; i < 3; i++)
+		app_regs.REG_AUTOTUNE_RESULT[i] = 0;
+	/* Position compare */
+	app_regs.REG_COMPARE_CONTROL = 0;
+	app_regs.REG_COMPARE_CONFIG_0[0] = 0;
+	app_regs.REG_COMPARE_CONFIG_0[1] = 100;
+	app_regs.REG_COMPARE_CONFIG_0[2] = 0;
+	app_regs.REG_COMPARE_CONFIG_1[0] = 0;
+	app_regs.REG_COMPARE_CONFIG_1[1] = 100;
+	app_regs.REG_COMPARE_CONFIG_1[2] = 0;
+	for (uint8_t i = 0; i < 8; i++)
+		app_regs.REG_COMPARE_TABLE[i] = 0;
+	app_regs.REG_COMPARE_PULSE_WIDTH = 100;
+	/* Waypoints */
+	for (uint8_t i = 0; i < 8; i++)
+		app_regs.REG_WAYPOINTS[i] = 0;
+	app_regs.REG_WAYPOINT_COUNT = 0;
+	for (uint8_t i = 0; i < 4; i++)
+		app_regs.REG_WAYPOINT_EVENT[i] = 0;
+	/* Move presets */
+	for (uint8_t i = 0; i < 4; i++)
+		app_regs.REG_PRESET_MOVE_TO[i] = move_preset_targets[i];
+	app_regs.REG_PRESET_RELATIVE = move_presets_relative;
+	app_regs.REG_PRESET_START = 0;
+	app_regs.REG_TRIGGER_PRESET = trigger_preset;
+	/* Sequencer */
+	for (uint8_t i = 0; i < 16; i++)
+		app_regs.REG_SEQUENCE[i] = 0;
+	app_regs.REG_SEQUENCE_CONTROL = 0;
+	app_regs.REG_SEQUENCE_INDEX = 0;
+	/* Binary link */
+	for (uint8_t i = 0; i < 2; i++)
+		app_regs.REG_BINARY_LINK_ERRORS[i] = 0;
+	/* Move report */
+	for (uint8_t i = 0; i < 5; i++)
+		app_regs.REG_MOVE_REPORT[i] = 0;
+	/* Motion profile */
+	app_regs.REG_MOTION_PROFILE[0] = motor_minimum_velocity;
+	app_regs.REG_MOTION_PROFILE[1] = motor_maximum_velocity;
+	app_regs.REG_MOTION_PROFILE[2] = (int32_t)motor_acceleration;
+	app_regs.REG_MOTION_PROFILE[3] = (int32_t)motor_deceleration;
+	app_regs.REG_MOTION_PROFILE[4] = (int32_t)motor_acceleration_jerk;
+	app_regs.REG_MOTION_PROFILE[5] = (int32_t)motor_deceleration_jerk;
 }
 
-extern int32_t motor_current_position;
 extern int32_t motor_target_position;
+extern uint8_t digital_inputs_previous_value;
 
 void core_callback_registers_were_reinitialized(void)
 {
 	/* Write register that have effect on other zones of the code */
 	app_write_REG_CONTROL(&app_regs.REG_CONTROL);
+	app_write_REG_MOTION_PROFILE(app_regs.REG_MOTION_PROFILE);
+	app_write_REG_QUICK_STOP_DECELERATION(&app_regs.REG_QUICK_STOP_DECELERATION);
+	app_write_REG_QUICK_STOP_JERK(&app_regs.REG_QUICK_STOP_JERK);
+	app_write_REG_FEED_OVERRIDE(&app_regs.REG_FEED_OVERRIDE);
+	app_write_REG_POSITION_LIMITS(app_regs.REG_POSITION_LIMITS);
+	app_write_REG_GEAR_RATIO(app_regs.REG_GEAR_RATIO);
+	app_write_REG_ANALOG_FOLLOW_CONFIG(app_regs.REG_ANALOG_FOLLOW_CONFIG);
+	app_write_REG_SUPERVISOR_CONFIG(app_regs.REG_SUPERVISOR_CONFIG);
+	app_write_REG_SUPERVISOR_CONTROL(&app_regs.REG_SUPERVISOR_CONTROL);
+	app_write_REG_AUTOTUNE_CONFIG(app_regs.REG_AUTOTUNE_CONFIG);
+	app_write_REG_HOME_VELOCITY(&app_regs.REG_HOME_VELOCITY);
+	app_write_REG_HOMING_CONFIG(app_regs.REG_HOMING_CONFIG);
+	app_write_REG_COMPARE_CONFIG_0(app_regs.REG_COMPARE_CONFIG_0);
+	app_write_REG_COMPARE_CONFIG_1(app_regs.REG_COMPARE_CONFIG_1);
+	app_write_REG_COMPARE_TABLE(app_regs.REG_COMPARE_TABLE);
+	app_write_REG_COMPARE_PULSE_WIDTH(&app_regs.REG_COMPARE_PULSE_WIDTH);
+	app_write_REG_COMPARE_CONTROL(&app_regs.REG_COMPARE_CONTROL);
+	app_write_REG_WAYPOINT_COUNT(&app_regs.REG_WAYPOINT_COUNT);
+	app_write_REG_TRACE_SIGNALS(&app_regs.REG_TRACE_SIGNALS);
+	app_write_REG_TRACE_DECIMATION(&app_regs.REG_TRACE_DECIMATION);
+	app_write_REG_TRIGGER_MOVE_TO(&app_regs.REG_TRIGGER_MOVE_TO);
+	app_write_REG_TRIGGER_CONFIG(&app_regs.REG_TRIGGER_CONFIG);
+	app_write_REG_PRESET_RELATIVE(&app_regs.REG_PRESET_RELATIVE);
+	app_write_REG_TRIGGER_PRESET(&app_regs.REG_TRIGGER_PRESET);
 
 	// @TODO: Make sure all necessary variables are initialized here	
 	//app_write_REG_NOMINAL_PULSE_INTERVAL(&app_regs.REG_NOMINAL_PULSE_INTERVAL);
@@ -160,6 +348,8 @@ void core_callback_registers_were_reinitialized(void)
 	/* Read external states */
 	app_read_REG_STOP_SWITCH();
 	app_read_REG_HOME_SWITCH();
+	app_read_REG_DIGITAL_INPUTS();
+	digital_inputs_previous_value = app_regs.REG_DIGITAL_INPUTS;
 }
 
 /************************************************************************/
@@ -194,24 +384,64 @@ void core_callback_device_to_speed(void) {}
 /* Callbacks: 1 ms timer                                                */
 /************************************************************************/
 int16_t quadrature_previous_value = 0;
-int8_t endstop_previous_value = -1;
+uint16_t frame_counter = 0;
+uint16_t position_event_counter = 0;
+int32_t position_previous_value = 0;
 
 extern bool send_motor_stopped_notification;
+extern bool pvt_is_running;
+extern bool gearing_is_running;
 
-extern bool motor_is_running;
+extern bool send_home_switch_notification;
+extern bool send_home_switch_latch_notification;
+extern int32_t home_switch_latch[3];
+extern uint8_t home_switch_events;
 
 extern float calculate_braking_distance();
 
 extern void update_motor_velocity();
 
-extern enum MovementStatus current_movement_status;
-
 //uint32_t counter = 0; 
 
+// Execute the commands queued by the binary link interrupt (the presets are started by the interrupt itself)
+static void execute_binary_link_commands(void)
+{
+	BinaryLinkCommand command;
+	
+	while (binary_link_queue_pop(&command))
+	{
+		switch (command.command)
+		{
+			case BINARY_LINK_CMD_MOVE_TO:
+				// Same restrictions as REG_MOVE_TO, but started right away instead of on the next 1 ms tick
+				if (!motor_is_taken())
+				{
+					sequence_release();
+					move_to_target_position(command.argument);
+				}
+				break;
+			
+			case BINARY_LINK_CMD_VELOCITY:
+				app_write_REG_DIRECT_VELOCITY(&command.argument);
+				break;
+			
+			case BINARY_LINK_CMD_STOP:
+				pvt_abort();
+				gearing_stop();
+				analog_follow_disable();
+				autotune_abort();
+				homing_abort();
+				sequence_abort();
+				quick_stop_motor();
+				break;
+		}
+	}
+}
+
 void core_callback_t_before_exec(void)
 {
-	/* Read ADC */
-	if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_ANALOG_IN)
+	/* Read ADC, unless the background ADC offset calibration is using it */
+	if (update_adc_offset_calibration() && (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_ANALOG_IN))
 	{
 		core_func_mark_user_timestamp();
 		start_analog_conversion();
@@ -229,6 +459,28 @@ void core_callback_t_before_exec(void)
 	}		
 	quadrature_previous_value = app_regs.REG_ENCODER;
 	
+	/* Report how the last movement to a target ended */
+	MoveReport move_report;
+	if (get_move_report(&move_report))
+	{
+		app_regs.REG_MOVE_REPORT[0] = (int32_t)move_report.second;
+		app_regs.REG_MOVE_REPORT[1] = (int32_t)move_report.microsecond;
+		app_regs.REG_MOVE_REPORT[2] = move_report.duration;
+		app_regs.REG_MOVE_REPORT[3] = move_report.peak_velocity;
+		app_regs.REG_MOVE_REPORT[4] = move_report.position_error;
+		core_func_send_event(ADD_REG_MOVE_REPORT, true);
+		
+		app_regs.REG_MOVE_TO_EVENTS = move_report.reason;
+		core_func_send_event(ADD_REG_MOVE_TO_EVENTS, true);
+	}
+	
+	/* Compare the motor position with the encoder */
+	if (supervisor_update())
+	{
+		app_regs.REG_FOLLOWING_ERROR = supervisor_get_following_error();
+		core_func_send_event(ADD_REG_FOLLOWING_ERROR, true);
+	}
+	
 	/* Notify that motor is stopped */
 	if (send_motor_stopped_notification)
 	{		
@@ -236,95 +488,122 @@ void core_callback_t_before_exec(void)
 		
 		app_regs.REG_MOVING = 0;
 		core_func_send_event(ADD_REG_MOVING, true);
+		
+		/* Report the position where the movement ended */
+		if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_POSITION_EVENTS)
+		{
+			app_regs.REG_POSITION = get_motor_position();
+			position_previous_value = app_regs.REG_POSITION;
+			core_func_send_event(ADD_REG_POSITION, true);
+		}
+		
+		/* Take the steps the encoder says were missed */
+		supervisor_on_motor_stopped();
+	}
+	
+	/* Decelerate before reaching a position limit */
+	check_position_limits();
+	
+	/* Execute the commands received by the binary link */
+	execute_binary_link_commands();
+	
+	/* Start a quick stop requested by REG_STOP_MOVEMENT or by the binary link */
+	start_requested_quick_stop();
+	
+	/* Ramp the feed override to the value requested on REG_FEED_OVERRIDE */
+	update_feed_override();
+	
+	/* The stop switch ends the analog follow mode, so the motor doesn't restart once the switch is released */
+	/* The fault flag stays set until the release, so the activation can't be missed here */
+	if (emergency_stop_is_active()) analog_follow_disable();
+	
+	/* Follow the analog input, unless the streamed setpoints or the encoder have control of the motor */
+	if ((app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_ANALOG_IN) && !pvt_is_running && !gearing_is_running)
+	{
+		if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_ANALOG_VELOCITY) analog_follow_update(ANALOG_FOLLOW_VELOCITY, app_regs.REG_ANALOG_INPUT);
+		else if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_ANALOG_POSITION) analog_follow_update(ANALOG_FOLLOW_POSITION, app_regs.REG_ANALOG_INPUT);
+		else analog_follow_update(ANALOG_FOLLOW_OFF, 0);
+	}
+	else
+	{
+		analog_follow_update(ANALOG_FOLLOW_OFF, 0);
 	}
 	
-	set_OUTPUT_0;	
-	// Check if the motor is moving and changing velocity
+	/* Ramp the jog velocity requested by REG_DIRECT_VELOCITY or by the analog input */
+	update_jog_velocity();
+	
+	// Check if the motor is moving towards a target or stopping
 	// If it is, we need to keep calculating the new velocity and breaking distance
-	if (motor_is_running && (current_movement_status==MOVEMENT_STATUS_ACCELERATING || current_movement_status==MOVEMENT_STATUS_DECELERATING))
+	// At constant velocity the braking distance is still needed to know when to start decelerating
+	if (motor_is_running && (current_movement_status==MOVEMENT_STATUS_ACCELERATING || current_movement_status==MOVEMENT_STATUS_CONSTANT_VELOCITY || current_movement_status==MOVEMENT_STATUS_DECELERATING || current_movement_status==MOVEMENT_STATUS_STOPPING))
 	{
-		float braking_distance = calculate_braking_distance();
-		clr_OUTPUT_0;
-		set_OUTPUT_0;
-		// @TODO: This is an error situation, should never happen
-		// Think on how to prevent this to begin with
-		if (isnan(braking_distance))
-		{
-			clr_OUTPUT_0;
-			set_OUTPUT_0;
-		}
-		clr_OUTPUT_0;
-		set_OUTPUT_0;
+		calculate_braking_distance();
+		
 		// Update the velocity, based on the acceleration and jerk parameters
 		update_motor_velocity();
-		clr_OUTPUT_0;
-		set_OUTPUT_0;
-		
-		// Sending this two events just for debugging purposes, remove it before release
-		//counter++;
-		//if (counter%20==0 && braking_distance > 0)
-		{
-			app_regs.REG_ACCELERATION = (int32_t)braking_distance;
-			core_func_send_event(ADD_REG_ACCELERATION, true);
-			int32_t remaining_distance = motor_target_position - motor_current_position;
-			app_regs.REG_DECELERATION = remaining_distance;
-			core_func_send_event(ADD_REG_DECELERATION, true);
-		}
-		
 	}
-	clr_OUTPUT_0;
 	
-	/* Check if the motor endstop state changed */
-	int8_t endstop_value = read_HOME_SWITCH;
-	if (endstop_value != endstop_previous_value)
+	/* Follow the position changes of the position compare while the motor is stopped */
+	position_compare_update();
+	
+	/* Report the waypoints reached since the last update */
+	waypoints_update();
+	while (waypoints_pop_crossing(app_regs.REG_WAYPOINT_EVENT))
+		core_func_send_event(ADD_REG_WAYPOINT_EVENT, true);
+	
+	/* Give the step output back to the timer once the stop switch is released */
+	if (emergency_stop_release())
 	{
-		endstop_previous_value = endstop_value;
-		if (endstop_value)
-		{
-			// @TODO: Is it worth to send the event on this case? Hummmm....
-			/* Update register and send event */
-			app_regs.REG_HOME_SWITCH = 0;
-			core_func_send_event(ADD_REG_HOME_SWITCH, true);
-		}
-		else
+		app_regs.REG_STOP_SWITCH = 0;
+		core_func_send_event(ADD_REG_STOP_SWITCH, true);
+	}
+	
+	/* Report the home switch activation latched by its interrupt */
+	if (send_home_switch_latch_notification)
+	{
+		send_home_switch_latch_notification = false;
+		
+		/* Disable medium and high level interrupts */
+		PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+		for (uint8_t i = 0; i < 3; i++)
+			app_regs.REG_HOME_SWITCH_LATCH[i] = home_switch_latch[i];
+		uint8_t events = home_switch_events;
+		/* Re-enable all interrupt levels */
+		PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+		
+		core_func_send_event(ADD_REG_HOME_SWITCH_LATCH, true);
+		
+		// The fast approach only decelerates past the switch, so there is nothing else to do until the slow approach
+		if (events)
 		{
-			/* Stop motor */
-			timer_type0_stop(&TCC0);
-			motor_is_running = false;
-			motor_current_position = 0;
+			// The motor may have done a step after the switch activated, so the origin is set at the latched position
+			set_motor_position(get_motor_position() - app_regs.REG_HOME_SWITCH_LATCH[0]);
+			supervisor_reset();
 			
-			// If the endstop switch was triggered while the motor was homing, that's perfect, it's what we want.
-			// So in this case, we will send the success event
-			if (current_movement_status==MOVEMENT_STATUS_HOMING)
-			{
-				app_regs.REG_HOME_STEPS_EVENTS = REG_HOME_STEPS_EVENTS_B_HOMING_SUCCESSFUL;								
-			}
-			// However, if the switch was triggered while we were not homing, it's an unexpected event
-			else
-			{
-				app_regs.REG_HOME_STEPS_EVENTS = REG_HOME_STEPS_EVENTS_B_UNEXPECTED_HOME;				
-			}
-			// Either way, we need to send an event
+			// Either a successful homing or an unexpected activation of the switch
+			app_regs.REG_HOME_STEPS_EVENTS = events;
 			core_func_send_event(ADD_REG_HOME_STEPS_EVENTS, true);
 			
 			current_movement_status=MOVEMENT_STATUS_STOPPED;
-				
-			// @TODO: Is it worth to send the event on this case? Hummmm....
-			/* Update register and send event */
-			app_regs.REG_HOME_SWITCH = REG_HOME_SWITCH_B_HOME_SWITCH;
-			core_func_send_event(ADD_REG_HOME_SWITCH, true);
-		}		
+		}
 	}
 	
-
-	
+	/* Check if the motor endstop state changed */
+	if (send_home_switch_notification)
+	{
+		send_home_switch_notification = false;
+		
+		/* Update register and send event */
+		app_read_REG_HOME_SWITCH();
+		core_func_send_event(ADD_REG_HOME_SWITCH, true);
+	}
 }
 
 void core_callback_t_after_exec(void) {}
 void core_callback_t_new_second(void) {}
 
 extern bool reg_control_was_updated;
-extern uint8_t temporary_reg_control;
+extern uint16_t temporary_reg_control;
 
 void core_callback_t_500us(void)
 {
@@ -349,11 +628,23 @@ bool requested_homing = false;
 int32_t requested_homing_distance = 0;
 
 
-extern void move_to_target_position(int32_t target_position);
-extern void move_to_home(int32_t homing_distance);
+extern bool move_to_target_position(int32_t target_position);
 
 extern uint8_t home_steps_events;
 
+extern bool send_trace_done_notification;
+
+extern bool send_scheduled_move_notification;
+extern int32_t scheduled_move_error;
+
+extern bool send_digital_inputs_notification;
+
+extern bool send_pvt_fill_notification;
+extern bool send_pvt_underrun_notification;
+
+extern bool send_position_limit_notification;
+extern uint8_t position_limit_events;
+
 
 void core_callback_t_1ms(void)
 {
@@ -370,6 +661,106 @@ void core_callback_t_1ms(void)
 		//PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
 	//}
 
+	// Motion parameters written while moving take effect once the motor stops
+	apply_pending_motion_profile();
+	
+	// Keep the prepared movements planned with the current motion profile and feed override
+	update_prepared_moves();
+	
+	// Drop partial binary link frames
+	binary_link_check_timeout();
+	
+	// Keep the ADC offset and the motion profile saved for the next power up
+	eeprom_config_update();
+	
+	// Send the synchronized sample frame, REG_FRAME_PERIOD is in ms
+	if (app_regs.REG_FRAME_PERIOD)
+	{
+		if (++frame_counter >= app_regs.REG_FRAME_PERIOD)
+		{
+			frame_counter = 0;
+			update_sample_frame();
+			core_func_send_event(ADD_REG_FRAME, true);
+		}
+	}
+	
+	// Send the motor position while it changes, REG_POSITION_EVENT_PERIOD is in ms
+	if (app_regs.REG_POSITION_EVENT_PERIOD)
+	{
+		if (++position_event_counter >= app_regs.REG_POSITION_EVENT_PERIOD)
+		{
+			position_event_counter = 0;
+			app_regs.REG_POSITION = get_motor_position();
+			
+			if (app_regs.REG_POSITION != position_previous_value)
+			{
+				position_previous_value = app_regs.REG_POSITION;
+				core_func_send_event(ADD_REG_POSITION, true);
+			}
+		}
+	}
+	
+	// Arm the start of a scheduled movement once its time is close
+	update_scheduled_move();
+	
+	// Report the start error of the scheduled movement
+	if (send_scheduled_move_notification)
+	{
+		send_scheduled_move_notification = false;
+		app_regs.REG_MOVE_AT_ERROR = scheduled_move_error;
+		core_func_send_event(ADD_REG_MOVE_AT_ERROR, true);
+	}
+
+	// Follow the streamed setpoints
+	pvt_update();
+	
+	if (send_pvt_fill_notification)
+	{
+		send_pvt_fill_notification = false;
+		app_regs.REG_PVT_FILL_LEVEL = pvt_get_fill_level();
+		core_func_send_event(ADD_REG_PVT_FILL_LEVEL, true);
+	}
+	
+	if (send_pvt_underrun_notification)
+	{
+		send_pvt_underrun_notification = false;
+		app_read_REG_PVT_CONTROL();
+		core_func_send_event(ADD_REG_PVT_CONTROL, true);
+	}
+	
+	// Report the position limit reached by the motor, or the limit a target was clamped to
+	if (send_position_limit_notification)
+	{
+		send_position_limit_notification = false;
+		app_regs.REG_POSITION_LIMIT_EVENTS = position_limit_events;
+		core_func_send_event(ADD_REG_POSITION_LIMIT_EVENTS, true);
+	}
+	
+	// Run the acceleration auto-tune trials and report the results when it ends
+	if (autotune_update())
+	{
+		app_read_REG_AUTOTUNE_RESULT();
+		core_func_send_event(ADD_REG_AUTOTUNE_RESULT, true);
+		app_read_REG_AUTOTUNE_CONTROL();
+		core_func_send_event(ADD_REG_AUTOTUNE_CONTROL, true);
+	}
+	
+	// Run the motion sequence and report when it ends
+	if (sequence_update())
+	{
+		app_read_REG_SEQUENCE_INDEX();
+		app_read_REG_SEQUENCE_CONTROL();
+		core_func_send_event(ADD_REG_SEQUENCE_CONTROL, true);
+	}
+	
+	// Report the digital inputs changes seen by the trigger interrupt
+	if (send_digital_inputs_notification)
+	{
+		send_digital_inputs_notification = false;
+		app_regs.REG_DIGITAL_INPUTS = read_digital_inputs();
+		core_func_send_event(ADD_REG_DIGITAL_INPUTS, true);
+	}
+
 	// Process new requests to update the target position	
 	if (updated_target_position)
 	{
@@ -381,7 +772,14 @@ void core_callback_t_1ms(void)
 	if (requested_homing)
 	{
 		requested_homing = false;
-		move_to_home(requested_homing_distance);
+		homing_start(requested_homing_distance);
+	}
+	
+	// Go through the phases of the homing and report each one
+	if (homing_update())
+	{
+		app_read_REG_HOMING_PHASE();
+		core_func_send_event(ADD_REG_HOMING_PHASE, true);
 	}
 
 	// If there was any home steps event to report, let's send it	
@@ -392,6 +790,14 @@ void core_callback_t_1ms(void)
 		home_steps_events = 0;
 	}
 	
+	// If a trace capture just finished, let the host know the data is ready
+	if (send_trace_done_notification)
+	{
+		send_trace_done_notification = false;
+		app_read_REG_TRACE_CONTROL();
+		core_func_send_event(ADD_REG_TRACE_CONTROL, true);
+	}
+	
 }
 
 /************************************************************************/
@@ -4,6 +4,17 @@
 
 #include "encoder.h"
 #include "stepper_motor.h"
+#include "trace_capture.h"
+#include "move_triggers.h"
+#include "pvt_stream.h"
+#include "electronic_gearing.h"
+#include "analog_follow.h"
+#include "encoder_supervisor.h"
+#include "acceleration_tune.h"
+#include "homing.h"
+#include "position_compare.h"
+#include "waypoints.h"
+#include "sequencer.h"
 
 /************************************************************************/
 /* Create pointers to functions                                         */
@@ -37,7 +48,83 @@ void (*app_func_rd_pointer[])(void) = {
 	&app_read_REG_HOME_STEPS,
 	&app_read_REG_HOME_STEPS_EVENTS,
 	&app_read_REG_HOME_VELOCITY,
-	&app_read_REG_HOME_SWITCH
+	&app_read_REG_HOME_SWITCH,
+	/* Synchronized sampling */
+	&app_read_REG_FRAME,
+	&app_read_REG_FRAME_PERIOD,
+	/* Trace capture */
+	&app_read_REG_TRACE_CONTROL,
+	&app_read_REG_TRACE_SIGNALS,
+	&app_read_REG_TRACE_DECIMATION,
+	&app_read_REG_TRACE_COUNT,
+	&app_read_REG_TRACE_READ_INDEX,
+	&app_read_REG_TRACE_DATA,
+	/* Position */
+	&app_read_REG_POSITION,
+	&app_read_REG_POSITION_EVENT_PERIOD,
+	/* Scheduled movement */
+	&app_read_REG_MOVE_AT,
+	&app_read_REG_MOVE_AT_ERROR,
+	/* Triggered movement */
+	&app_read_REG_DIGITAL_INPUTS,
+	&app_read_REG_TRIGGER_CONFIG,
+	&app_read_REG_TRIGGER_MOVE_TO,
+	/* Streamed movement */
+	&app_read_REG_PVT_POINT,
+	&app_read_REG_PVT_CONTROL,
+	&app_read_REG_PVT_FILL_LEVEL,
+	/* Motion profile */
+	&app_read_REG_MOTION_PROFILE,
+	/* Move report */
+	&app_read_REG_MOVE_REPORT,
+	/* Quick stop */
+	&app_read_REG_QUICK_STOP_DECELERATION,
+	&app_read_REG_QUICK_STOP_JERK,
+	/* Feed override */
+	&app_read_REG_FEED_OVERRIDE,
+	/* Position limits */
+	&app_read_REG_POSITION_LIMITS,
+	&app_read_REG_POSITION_LIMIT_EVENTS,
+	/* Electronic gearing */
+	&app_read_REG_GEAR_RATIO,
+	&app_read_REG_GEARING_CONTROL,
+	/* Analog following */
+	&app_read_REG_ANALOG_FOLLOW_CONFIG,
+	/* Encoder supervisor */
+	&app_read_REG_SUPERVISOR_CONFIG,
+	&app_read_REG_SUPERVISOR_CONTROL,
+	&app_read_REG_FOLLOWING_ERROR,
+	/* Acceleration auto-tune */
+	&app_read_REG_AUTOTUNE_CONFIG,
+	&app_read_REG_AUTOTUNE_CONTROL,
+	&app_read_REG_AUTOTUNE_RESULT,
+	/* Homing */
+	&app_read_REG_HOMING_CONFIG,
+	&app_read_REG_HOMING_PHASE,
+	&app_read_REG_HOME_SWITCH_LATCH,
+	/* Emergency stop */
+	&app_read_REG_STOP_LATENCY,
+	/* Position compare */
+	&app_read_REG_COMPARE_CONTROL,
+	&app_read_REG_COMPARE_CONFIG_0,
+	&app_read_REG_COMPARE_CONFIG_1,
+	&app_read_REG_COMPARE_TABLE,
+	&app_read_REG_COMPARE_PULSE_WIDTH,
+	/* Waypoints */
+	&app_read_REG_WAYPOINTS,
+	&app_read_REG_WAYPOINT_COUNT,
+	&app_read_REG_WAYPOINT_EVENT,
+	/* Move presets */
+	&app_read_REG_PRESET_MOVE_TO,
+	&app_read_REG_PRESET_RELATIVE,
+	&app_read_REG_PRESET_START,
+	&app_read_REG_TRIGGER_PRESET,
+	/* Sequencer */
+	&app_read_REG_SEQUENCE,
+	&app_read_REG_SEQUENCE_CONTROL,
+	&app_read_REG_SEQUENCE_INDEX,
+	/* Binary link */
+	&app_read_REG_BINARY_LINK_ERRORS
 };
 
 bool (*app_func_wr_pointer[])(void*) = {
@@ -66,7 +153,83 @@ bool (*app_func_wr_pointer[])(void*) = {
 	&app_write_REG_HOME_STEPS,
 	&app_write_REG_HOME_STEPS_EVENTS,
 	&app_write_REG_HOME_VELOCITY,
-	&app_write_REG_HOME_SWITCH
+	&app_write_REG_HOME_SWITCH,
+	/* Synchronized sampling */
+	&app_write_REG_FRAME,
+	&app_write_REG_FRAME_PERIOD,
+	/* Trace capture */
+	&app_write_REG_TRACE_CONTROL,
+	&app_write_REG_TRACE_SIGNALS,
+	&app_write_REG_TRACE_DECIMATION,
+	&app_write_REG_TRACE_COUNT,
+	&app_write_REG_TRACE_READ_INDEX,
+	&app_write_REG_TRACE_DATA,
+	/* Position */
+	&app_write_REG_POSITION,
+	&app_write_REG_POSITION_EVENT_PERIOD,
+	/* Scheduled movement */
+	&app_write_REG_MOVE_AT,
+	&app_write_REG_MOVE_AT_ERROR,
+	/* Triggered movement */
+	&app_write_REG_DIGITAL_INPUTS,
+	&app_write_REG_TRIGGER_CONFIG,
+	&app_write_REG_TRIGGER_MOVE_TO,
+	/* Streamed movement */
+	&app_write_REG_PVT_POINT,
+	&app_write_REG_PVT_CONTROL,
+	&app_write_REG_PVT_FILL_LEVEL,
+	/* Motion profile */
+	&app_write_REG_MOTION_PROFILE,
+	/* Move report */
+	&app_write_REG_MOVE_REPORT,
+	/* Quick stop */
+	&app_write_REG_QUICK_STOP_DECELERATION,
+	&app_write_REG_QUICK_STOP_JERK,
+	/* Feed override */
+	&app_write_REG_FEED_OVERRIDE,
+	/* Position limits */
+	&app_write_REG_POSITION_LIMITS,
+	&app_write_REG_POSITION_LIMIT_EVENTS,
+	/* Electronic gearing */
+	&app_write_REG_GEAR_RATIO,
+	&app_write_REG_GEARING_CONTROL,
+	/* Analog following */
+	&app_write_REG_ANALOG_FOLLOW_CONFIG,
+	/* Encoder supervisor */
+	&app_write_REG_SUPERVISOR_CONFIG,
+	&app_write_REG_SUPERVISOR_CONTROL,
+	&app_write_REG_FOLLOWING_ERROR,
+	/* Acceleration auto-tune */
+	&app_write_REG_AUTOTUNE_CONFIG,
+	&app_write_REG_AUTOTUNE_CONTROL,
+	&app_write_REG_AUTOTUNE_RESULT,
+	/* Homing */
+	&app_write_REG_HOMING_CONFIG,
+	&app_write_REG_HOMING_PHASE,
+	&app_write_REG_HOME_SWITCH_LATCH,
+	/* Emergency stop */
+	&app_write_REG_STOP_LATENCY,
+	/* Position compare */
+	&app_write_REG_COMPARE_CONTROL,
+	&app_write_REG_COMPARE_CONFIG_0,
+	&app_write_REG_COMPARE_CONFIG_1,
+	&app_write_REG_COMPARE_TABLE,
+	&app_write_REG_COMPARE_PULSE_WIDTH,
+	/* Waypoints */
+	&app_write_REG_WAYPOINTS,
+	&app_write_REG_WAYPOINT_COUNT,
+	&app_write_REG_WAYPOINT_EVENT,
+	/* Move presets */
+	&app_write_REG_PRESET_MOVE_TO,
+	&app_write_REG_PRESET_RELATIVE,
+	&app_write_REG_PRESET_START,
+	&app_write_REG_TRIGGER_PRESET,
+	/* Sequencer */
+	&app_write_REG_SEQUENCE,
+	&app_write_REG_SEQUENCE_CONTROL,
+	&app_write_REG_SEQUENCE_INDEX,
+	/* Binary link */
+	&app_write_REG_BINARY_LINK_ERRORS
 };
 
 
@@ -106,6 +269,37 @@ void app_read_REG_CONTROL(void)
 	{
 		temp |= REG_CONTROL_B_DISABLE_QUAD_ENCODER;
 	}
+	
+	if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_POSITION_EVENTS)
+	{
+		temp |= REG_CONTROL_B_ENABLE_POSITION_EVENTS;
+	}
+	else
+	{
+		temp |= REG_CONTROL_B_DISABLE_POSITION_EVENTS;
+	}
+	
+	if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_POSITION_LIMITS)
+	{
+		temp |= REG_CONTROL_B_ENABLE_POSITION_LIMITS;
+	}
+	else
+	{
+		temp |= REG_CONTROL_B_DISABLE_POSITION_LIMITS;
+	}
+	
+	if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_ANALOG_VELOCITY)
+	{
+		temp |= REG_CONTROL_B_ENABLE_ANALOG_VELOCITY;
+	}
+	else if (app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_ANALOG_POSITION)
+	{
+		temp |= REG_CONTROL_B_ENABLE_ANALOG_POSITION;
+	}
+	else
+	{
+		temp |= REG_CONTROL_B_DISABLE_ANALOG_FOLLOW;
+	}
 
 	app_regs.REG_CONTROL = temp;
 }
@@ -125,11 +319,24 @@ bool app_write_REG_CONTROL(void *a)
 	if (reg & REG_CONTROL_B_ENABLE_QUAD_ENCODER)  { temporary_reg_control |=  REG_CONTROL_B_ENABLE_QUAD_ENCODER; temporary_reg_control &=  ~REG_CONTROL_B_DISABLE_QUAD_ENCODER; }
 	if (reg & REG_CONTROL_B_DISABLE_QUAD_ENCODER) { temporary_reg_control &= ~REG_CONTROL_B_ENABLE_QUAD_ENCODER; temporary_reg_control |=   REG_CONTROL_B_DISABLE_QUAD_ENCODER; }
 	
+	if (reg & REG_CONTROL_B_ENABLE_POSITION_EVENTS)  { temporary_reg_control |=  REG_CONTROL_B_ENABLE_POSITION_EVENTS; temporary_reg_control &=  ~REG_CONTROL_B_DISABLE_POSITION_EVENTS; }
+	if (reg & REG_CONTROL_B_DISABLE_POSITION_EVENTS) { temporary_reg_control &= ~REG_CONTROL_B_ENABLE_POSITION_EVENTS; temporary_reg_control |=   REG_CONTROL_B_DISABLE_POSITION_EVENTS; }
+	
+	if (reg & REG_CONTROL_B_ENABLE_POSITION_LIMITS)  { temporary_reg_control |=  REG_CONTROL_B_ENABLE_POSITION_LIMITS; temporary_reg_control &=  ~REG_CONTROL_B_DISABLE_POSITION_LIMITS; }
+	if (reg & REG_CONTROL_B_DISABLE_POSITION_LIMITS) { temporary_reg_control &= ~REG_CONTROL_B_ENABLE_POSITION_LIMITS; temporary_reg_control |=   REG_CONTROL_B_DISABLE_POSITION_LIMITS; }
+	
+	if (reg & REG_CONTROL_B_ENABLE_ANALOG_VELOCITY) { temporary_reg_control |=  REG_CONTROL_B_ENABLE_ANALOG_VELOCITY; temporary_reg_control &= ~(REG_CONTROL_B_ENABLE_ANALOG_POSITION | REG_CONTROL_B_DISABLE_ANALOG_FOLLOW); }
+	if (reg & REG_CONTROL_B_ENABLE_ANALOG_POSITION) { temporary_reg_control |=  REG_CONTROL_B_ENABLE_ANALOG_POSITION; temporary_reg_control &= ~(REG_CONTROL_B_ENABLE_ANALOG_VELOCITY | REG_CONTROL_B_DISABLE_ANALOG_FOLLOW); }
+	if (reg & REG_CONTROL_B_DISABLE_ANALOG_FOLLOW)  { temporary_reg_control &= ~(REG_CONTROL_B_ENABLE_ANALOG_VELOCITY | REG_CONTROL_B_ENABLE_ANALOG_POSITION); temporary_reg_control |= REG_CONTROL_B_DISABLE_ANALOG_FOLLOW; }
+	
 	if (reg & REG_CONTROL_B_RESET_QUAD_ENCODER)
 	{
 		reset_quadrature_encoder();
+		supervisor_reset();
 	}
 	
+	enable_position_limits((temporary_reg_control & REG_CONTROL_B_ENABLE_POSITION_LIMITS) ? true : false);
+	
 	if (temporary_reg_control & REG_CONTROL_B_ENABLE_MOTOR)
 	{
 		set_MOTOR_ENABLE;
@@ -235,6 +442,16 @@ void app_read_REG_STOP_MOVEMENT(void)
 
 bool app_write_REG_STOP_MOVEMENT(void *a)
 {
+	// The streamed setpoints, the encoder or the analog input would start the motor again
+	pvt_abort();
+	gearing_stop();
+	analog_follow_disable();
+	autotune_abort();
+	homing_abort();
+	sequence_abort();
+	
+	// Decelerate as fast as allowed, so no steps are lost and the position stays valid
+	quick_stop_motor();
 	return true;
 }
 
@@ -245,14 +462,23 @@ void app_read_REG_DIRECT_VELOCITY(void)
 {
 }
 
-extern void set_motor_step_period(int32_t period);
+extern bool pvt_is_running;
+extern bool gearing_is_running;
+extern bool autotune_is_running;
 
 bool app_write_REG_DIRECT_VELOCITY(void *a)
 {
 	int32_t reg = *((int32_t*)a);
+	
+	// The streamed setpoints, the encoder, the analog input, the auto-tune or the homing have control of the motor
+	if (motor_is_taken()) return false;
 
-	set_motor_step_period(reg);
+	if (!set_jog_velocity(reg)) return false;
 	
+	// The motor now follows this command, not the motion sequence
+	sequence_release();
+	
+	app_regs.REG_DIRECT_VELOCITY = reg;
 	return true;
 }
 
@@ -267,9 +493,13 @@ extern bool updated_target_position;
 extern int32_t requested_target_position;
 bool app_write_REG_MOVE_TO(void *a)
 {
+	// Will not allow a new target while the motor follows the streamed setpoints, the encoder, the analog input, the auto-tune or the homing
+	if (motor_is_taken()) return false;
 	// Save the requested target position update so it's processed on the main loop
 	requested_target_position = *((int32_t*)a);
 	updated_target_position = true;
+	// The motor now follows this command, not the motion sequence
+	sequence_release();
 	return true;
 }
 
@@ -288,49 +518,66 @@ bool app_write_REG_MOVE_TO_EVENTS(void *a)
 /************************************************************************/
 /* REG_MIN_VELOCITY                                                     */
 /************************************************************************/
-extern uint16_t motor_minimum_velocity;
-
 void app_read_REG_MIN_VELOCITY(void)
 {
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	app_regs.REG_MIN_VELOCITY = profile.minimum_velocity;
 }
 
 bool app_write_REG_MIN_VELOCITY(void *a)
 {
-	//motor_minimum_velocity = *((uint16_t*)a);
-	app_regs.REG_MIN_VELOCITY = motor_minimum_velocity;	
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	profile.minimum_velocity = *((uint16_t*)a);
+	
+	if (!set_motion_profile(&profile)) return false;
+	
+	app_regs.REG_MIN_VELOCITY = profile.minimum_velocity;
 	return true;
 }
 
 /************************************************************************/
 /* REG_MAX_VELOCITY                                                     */
 /************************************************************************/
-extern uint16_t motor_maximum_velocity;
-
 void app_read_REG_MAX_VELOCITY(void)
 {
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	app_regs.REG_MAX_VELOCITY = profile.maximum_velocity;
 }
 
 bool app_write_REG_MAX_VELOCITY(void *a)
 {
-	//motor_maximum_velocity = *((uint16_t*)a);
-	app_regs.REG_MAX_VELOCITY = motor_maximum_velocity;
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	profile.maximum_velocity = *((uint16_t*)a);
+	
+	if (!set_motion_profile(&profile)) return false;
+	
+	app_regs.REG_MAX_VELOCITY = profile.maximum_velocity;
 	return true;
 }
 
 /************************************************************************/
 /* REG_ACCELERATION                                                     */
 /************************************************************************/
-extern float motor_acceleration;
-
 void app_read_REG_ACCELERATION(void)
 {
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	app_regs.REG_ACCELERATION = (int32_t)profile.acceleration;
 }
 
 bool app_write_REG_ACCELERATION(void *a)
 {
-	int32_t reg = *((int32_t*)a);
-	app_regs.REG_ACCELERATION = reg;
-	motor_acceleration = (float)reg;
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	profile.acceleration = (float)*((int32_t*)a);
+	
+	if (!set_motion_profile(&profile)) return false;
+	
+	app_regs.REG_ACCELERATION = *((int32_t*)a);
 	return true;	
 }
 
@@ -338,51 +585,66 @@ bool app_write_REG_ACCELERATION(void *a)
 /************************************************************************/
 /* REG_DECELERATION                                                     */
 /************************************************************************/
-extern float motor_deceleration;
-
 void app_read_REG_DECELERATION(void)
 {
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	app_regs.REG_DECELERATION = (int32_t)profile.deceleration;
 }
 
 bool app_write_REG_DECELERATION(void *a)
 {
-	int32_t reg = *((int32_t*)a);
-	app_regs.REG_DECELERATION = reg;
-	motor_deceleration = (float)reg;
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	profile.deceleration = (float)*((int32_t*)a);
+	
+	if (!set_motion_profile(&profile)) return false;
+	
+	app_read_REG_DECELERATION();
 	return true;
 }
 
 /************************************************************************/
 /* REG_ACCELERATION_JERK                                                */
 /************************************************************************/
-extern float motor_acceleration_jerk;
-
 void app_read_REG_ACCELERATION_JERK(void)
 {
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	app_regs.REG_ACCELERATION_JERK = (int32_t)profile.acceleration_jerk;
 }
 
 bool app_write_REG_ACCELERATION_JERK(void *a)
 {
-	int32_t reg = *((int32_t*)a);
-	app_regs.REG_ACCELERATION_JERK = reg;
-	motor_acceleration_jerk = (float)reg;
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	profile.acceleration_jerk = (float)*((int32_t*)a);
+	
+	if (!set_motion_profile(&profile)) return false;
+	
+	app_regs.REG_ACCELERATION_JERK = *((int32_t*)a);
 	return true;
 }
 
 /************************************************************************/
 /* REG_DECELERATION_JERK                                                */
 /************************************************************************/
-extern float motor_deceleration_jerk;
-
 void app_read_REG_DECELERATION_JERK(void)
 {
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	app_regs.REG_DECELERATION_JERK = (int32_t)profile.deceleration_jerk;
 }
 
 bool app_write_REG_DECELERATION_JERK(void *a)
 {
-	int32_t reg = *((int32_t*)a);
-	app_regs.REG_DECELERATION_JERK = reg;
-	motor_deceleration_jerk = (float)reg;
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	profile.deceleration_jerk = (float)*((int32_t*)a);
+	
+	if (!set_motion_profile(&profile)) return false;
+	
+	app_read_REG_DECELERATION_JERK();
 	return true;
 }
 
@@ -399,7 +661,7 @@ extern int32_t requested_homing_distance;
 bool app_write_REG_HOME_STEPS(void *a)
 {
 	// Will not allow to start a homing procedure if the motor is currently moving
-	if (motor_is_running) return false;
+	if (motor_is_running || motor_is_taken()) return false;
 	// Save the requested homing max distance so it's processed on the main loop
 	requested_homing_distance = *((int32_t*)a);
 	requested_homing = true;
@@ -427,6 +689,11 @@ void app_read_REG_HOME_VELOCITY(void)
 
 bool app_write_REG_HOME_VELOCITY(void *a)
 {
+	uint32_t reg = *((uint32_t*)a);
+	
+	if (!homing_set_velocity(reg)) return false;
+	
+	app_regs.REG_HOME_VELOCITY = reg;
 	return true;
 }
 
@@ -443,3 +710,1051 @@ bool app_write_REG_HOME_SWITCH(void *a)
 	return false;
 }
 
+/************************************************************************/
+/* REG_FRAME                                                            */
+/************************************************************************/
+extern void update_sample_frame(void);
+
+void app_read_REG_FRAME(void)
+{
+	update_sample_frame();
+}
+
+bool app_write_REG_FRAME(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_FRAME_PERIOD                                                     */
+/************************************************************************/
+void app_read_REG_FRAME_PERIOD(void)
+{
+}
+
+bool app_write_REG_FRAME_PERIOD(void *a)
+{
+	app_regs.REG_FRAME_PERIOD = *((uint16_t*)a);
+	return true;
+}
+
+/************************************************************************/
+/* REG_TRACE_CONTROL                                                    */
+/************************************************************************/
+extern bool trace_is_armed;
+extern bool trace_is_running;
+extern bool trace_is_done;
+extern bool trace_wrapped;
+
+void app_read_REG_TRACE_CONTROL(void)
+{
+	uint8_t temp = 0;
+	
+	if (trace_is_armed) temp |= REG_TRACE_CONTROL_B_ARMED;
+	if (trace_is_running) temp |= REG_TRACE_CONTROL_B_RUNNING;
+	if (trace_is_done) temp |= REG_TRACE_CONTROL_B_DONE;
+	if (trace_wrapped) temp |= REG_TRACE_CONTROL_B_OVERFLOW;
+	
+	app_regs.REG_TRACE_CONTROL = temp;
+}
+
+bool app_write_REG_TRACE_CONTROL(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg & REG_TRACE_CONTROL_B_STOP)
+	{
+		trace_stop();
+	}
+	else if (reg & REG_TRACE_CONTROL_B_START)
+	{
+		trace_start();
+		app_regs.REG_TRACE_READ_INDEX = 0;
+	}
+	else if (reg & REG_TRACE_CONTROL_B_ARM)
+	{
+		trace_arm();
+		app_regs.REG_TRACE_READ_INDEX = 0;
+	}
+	
+	app_read_REG_TRACE_CONTROL();
+	return true;
+}
+
+/************************************************************************/
+/* REG_TRACE_SIGNALS                                                    */
+/************************************************************************/
+extern uint8_t trace_signals;
+
+void app_read_REG_TRACE_SIGNALS(void)
+{
+}
+
+bool app_write_REG_TRACE_SIGNALS(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	// Signals can't change while capturing since the number of words per sample would change
+	if (trace_is_running || reg == 0 || (reg & 0xF0)) return false;
+	
+	trace_signals = reg;
+	app_regs.REG_TRACE_SIGNALS = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_TRACE_DECIMATION                                                 */
+/************************************************************************/
+extern uint8_t trace_decimation;
+
+void app_read_REG_TRACE_DECIMATION(void)
+{
+}
+
+bool app_write_REG_TRACE_DECIMATION(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg == 0) return false;
+	
+	trace_decimation = reg;
+	app_regs.REG_TRACE_DECIMATION = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_TRACE_COUNT                                                      */
+/************************************************************************/
+void app_read_REG_TRACE_COUNT(void)
+{
+	app_regs.REG_TRACE_COUNT = trace_get_count();
+}
+
+bool app_write_REG_TRACE_COUNT(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_TRACE_READ_INDEX                                                 */
+/************************************************************************/
+void app_read_REG_TRACE_READ_INDEX(void)
+{
+}
+
+bool app_write_REG_TRACE_READ_INDEX(void *a)
+{
+	app_regs.REG_TRACE_READ_INDEX = *((uint16_t*)a);
+	return true;
+}
+
+/************************************************************************/
+/* REG_TRACE_DATA                                                       */
+/************************************************************************/
+void app_read_REG_TRACE_DATA(void)
+{
+	trace_read_block(app_regs.REG_TRACE_DATA, app_regs.REG_TRACE_READ_INDEX, TRACE_DATA_BLOCK_WORDS);
+	app_regs.REG_TRACE_READ_INDEX += TRACE_DATA_BLOCK_WORDS;
+}
+
+bool app_write_REG_TRACE_DATA(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_POSITION                                                         */
+/************************************************************************/
+void app_read_REG_POSITION(void)
+{
+	app_regs.REG_POSITION = get_motor_position();
+}
+
+bool app_write_REG_POSITION(void *a)
+{
+	int32_t reg = *((int32_t*)a);
+	
+	set_motor_position(reg);
+	supervisor_reset();
+	
+	app_regs.REG_POSITION = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_POSITION_EVENT_PERIOD                                            */
+/************************************************************************/
+void app_read_REG_POSITION_EVENT_PERIOD(void)
+{
+}
+
+bool app_write_REG_POSITION_EVENT_PERIOD(void *a)
+{
+	app_regs.REG_POSITION_EVENT_PERIOD = *((uint16_t*)a);
+	return true;
+}
+
+/************************************************************************/
+/* REG_MOVE_AT                                                          */
+/************************************************************************/
+void app_read_REG_MOVE_AT(void)
+{
+}
+
+bool app_write_REG_MOVE_AT(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (reg[1] < 0)
+	{
+		cancel_scheduled_move();
+	}
+	else if (motor_is_taken())
+	{
+		// Same restrictions as REG_MOVE_TO, checked again when the movement starts
+		return false;
+	}
+	else if (!schedule_move(reg[0], (uint32_t)reg[1], (uint32_t)reg[2]))
+	{
+		return false;
+	}
+	
+	app_regs.REG_MOVE_AT[0] = reg[0];
+	app_regs.REG_MOVE_AT[1] = reg[1];
+	app_regs.REG_MOVE_AT[2] = reg[2];
+	return true;
+}
+
+/************************************************************************/
+/* REG_MOVE_AT_ERROR                                                    */
+/************************************************************************/
+void app_read_REG_MOVE_AT_ERROR(void)
+{
+}
+
+bool app_write_REG_MOVE_AT_ERROR(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_DIGITAL_INPUTS                                                   */
+/************************************************************************/
+void app_read_REG_DIGITAL_INPUTS(void)
+{
+	app_regs.REG_DIGITAL_INPUTS = read_digital_inputs();
+}
+
+bool app_write_REG_DIGITAL_INPUTS(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_TRIGGER_CONFIG                                                   */
+/************************************************************************/
+extern uint8_t trigger_config;
+
+void app_read_REG_TRIGGER_CONFIG(void)
+{
+}
+
+bool app_write_REG_TRIGGER_CONFIG(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	trigger_config = reg;
+	
+	app_regs.REG_TRIGGER_CONFIG = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_TRIGGER_MOVE_TO                                                  */
+/************************************************************************/
+void app_read_REG_TRIGGER_MOVE_TO(void)
+{
+}
+
+bool app_write_REG_TRIGGER_MOVE_TO(void *a)
+{
+	int32_t reg = *((int32_t*)a);
+	
+	/* Disable high level interrupts so the trigger doesn't see a half planned movement */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm;
+	prepare_trigger_move(reg);
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	app_regs.REG_TRIGGER_MOVE_TO = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_PVT_POINT                                                        */
+/************************************************************************/
+void app_read_REG_PVT_POINT(void)
+{
+}
+
+bool app_write_REG_PVT_POINT(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (reg[2] <= 0 || reg[2] > 0xFFFF) return false;
+	if (!pvt_push_point(reg[0], reg[1], (uint16_t)reg[2])) return false;
+	
+	app_regs.REG_PVT_POINT[0] = reg[0];
+	app_regs.REG_PVT_POINT[1] = reg[1];
+	app_regs.REG_PVT_POINT[2] = reg[2];
+	return true;
+}
+
+/************************************************************************/
+/* REG_PVT_CONTROL                                                      */
+/************************************************************************/
+extern bool pvt_underrun;
+
+void app_read_REG_PVT_CONTROL(void)
+{
+	uint8_t temp = 0;
+	
+	if (pvt_is_running) temp |= REG_PVT_CONTROL_B_RUNNING;
+	if (pvt_underrun) temp |= REG_PVT_CONTROL_B_UNDERRUN;
+	
+	app_regs.REG_PVT_CONTROL = temp;
+}
+
+bool app_write_REG_PVT_CONTROL(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg & REG_PVT_CONTROL_B_STOP)
+	{
+		pvt_stop();
+	}
+	else if (reg & REG_PVT_CONTROL_B_START)
+	{
+		if (!pvt_start()) return false;
+	}
+	
+	if (reg & REG_PVT_CONTROL_B_CLEAR)
+	{
+		pvt_clear();
+	}
+	
+	app_read_REG_PVT_CONTROL();
+	return true;
+}
+
+/************************************************************************/
+/* REG_PVT_FILL_LEVEL                                                   */
+/************************************************************************/
+void app_read_REG_PVT_FILL_LEVEL(void)
+{
+	app_regs.REG_PVT_FILL_LEVEL = pvt_get_fill_level();
+}
+
+bool app_write_REG_PVT_FILL_LEVEL(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_MOTION_PROFILE                                                   */
+/************************************************************************/
+void app_read_REG_MOTION_PROFILE(void)
+{
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	
+	app_regs.REG_MOTION_PROFILE[0] = profile.minimum_velocity;
+	app_regs.REG_MOTION_PROFILE[1] = profile.maximum_velocity;
+	app_regs.REG_MOTION_PROFILE[2] = (int32_t)profile.acceleration;
+	app_regs.REG_MOTION_PROFILE[3] = (int32_t)profile.deceleration;
+	app_regs.REG_MOTION_PROFILE[4] = (int32_t)profile.acceleration_jerk;
+	app_regs.REG_MOTION_PROFILE[5] = (int32_t)profile.deceleration_jerk;
+}
+
+bool app_write_REG_MOTION_PROFILE(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	MotionProfile profile;
+	
+	// Velocities must fit the U16 registers that expose them individually
+	if (reg[0] < 0 || reg[0] > 0xFFFF || reg[1] < 0 || reg[1] > 0xFFFF) return false;
+	
+	profile.minimum_velocity = (uint16_t)reg[0];
+	profile.maximum_velocity = (uint16_t)reg[1];
+	profile.acceleration = (float)reg[2];
+	profile.deceleration = (float)reg[3];
+	profile.acceleration_jerk = (float)reg[4];
+	profile.deceleration_jerk = (float)reg[5];
+	
+	// All the parameters are validated together, either all are accepted or none is
+	if (!set_motion_profile(&profile)) return false;
+	
+	app_read_REG_MOTION_PROFILE();
+	return true;
+}
+
+/************************************************************************/
+/* REG_MOVE_REPORT                                                      */
+/************************************************************************/
+void app_read_REG_MOVE_REPORT(void)
+{
+}
+
+bool app_write_REG_MOVE_REPORT(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_QUICK_STOP_DECELERATION                                          */
+/************************************************************************/
+extern float motor_quick_stop_deceleration;
+
+void app_read_REG_QUICK_STOP_DECELERATION(void)
+{
+}
+
+bool app_write_REG_QUICK_STOP_DECELERATION(void *a)
+{
+	int32_t reg = *((int32_t*)a);
+	
+	if (reg == 0) return false;
+	
+	// The deceleration is used as a negative value, no matter the sign it was given with
+	if (reg > 0) reg = -reg;
+	
+	app_regs.REG_QUICK_STOP_DECELERATION = reg;
+	motor_quick_stop_deceleration = (float)reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_QUICK_STOP_JERK                                                  */
+/************************************************************************/
+extern float motor_quick_stop_jerk;
+
+void app_read_REG_QUICK_STOP_JERK(void)
+{
+}
+
+bool app_write_REG_QUICK_STOP_JERK(void *a)
+{
+	int32_t reg = *((int32_t*)a);
+	
+	if (reg == 0) return false;
+	
+	// The jerk is used as a negative value, no matter the sign it was given with
+	if (reg > 0) reg = -reg;
+	
+	app_regs.REG_QUICK_STOP_JERK = reg;
+	motor_quick_stop_jerk = (float)reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_FEED_OVERRIDE                                                    */
+/************************************************************************/
+void app_read_REG_FEED_OVERRIDE(void)
+{
+}
+
+bool app_write_REG_FEED_OVERRIDE(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (!set_feed_override(reg)) return false;
+	
+	app_regs.REG_FEED_OVERRIDE = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_POSITION_LIMITS                                                  */
+/************************************************************************/
+void app_read_REG_POSITION_LIMITS(void)
+{
+}
+
+bool app_write_REG_POSITION_LIMITS(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!set_position_limits(reg[0], reg[1])) return false;
+	
+	app_regs.REG_POSITION_LIMITS[0] = reg[0];
+	app_regs.REG_POSITION_LIMITS[1] = reg[1];
+	return true;
+}
+
+/************************************************************************/
+/* REG_POSITION_LIMIT_EVENTS                                            */
+/************************************************************************/
+void app_read_REG_POSITION_LIMIT_EVENTS(void)
+{
+}
+
+bool app_write_REG_POSITION_LIMIT_EVENTS(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_GEAR_RATIO                                                       */
+/************************************************************************/
+void app_read_REG_GEAR_RATIO(void)
+{
+}
+
+bool app_write_REG_GEAR_RATIO(void *a)
+{
+	int16_t *reg = ((int16_t*)a);
+	
+	if (!gearing_set_ratio(reg[0], reg[1])) return false;
+	
+	app_regs.REG_GEAR_RATIO[0] = reg[0];
+	app_regs.REG_GEAR_RATIO[1] = reg[1];
+	return true;
+}
+
+/************************************************************************/
+/* REG_GEARING_CONTROL                                                  */
+/************************************************************************/
+void app_read_REG_GEARING_CONTROL(void)
+{
+	app_regs.REG_GEARING_CONTROL = (gearing_is_running) ? REG_GEARING_CONTROL_B_RUNNING : 0;
+}
+
+bool app_write_REG_GEARING_CONTROL(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg & REG_GEARING_CONTROL_B_STOP)
+	{
+		gearing_stop();
+	}
+	else if (reg & REG_GEARING_CONTROL_B_START)
+	{
+		if (!gearing_start()) return false;
+	}
+	
+	app_read_REG_GEARING_CONTROL();
+	return true;
+}
+
+/************************************************************************/
+/* REG_ANALOG_FOLLOW_CONFIG                                             */
+/************************************************************************/
+void app_read_REG_ANALOG_FOLLOW_CONFIG(void)
+{
+}
+
+bool app_write_REG_ANALOG_FOLLOW_CONFIG(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!analog_follow_set_config(reg[0], reg[1], reg[2], reg[3], reg[4])) return false;
+	
+	for (uint8_t i = 0; i < 5; i++)
+		app_regs.REG_ANALOG_FOLLOW_CONFIG[i] = reg[i];
+	return true;
+}
+
+/************************************************************************/
+/* REG_SUPERVISOR_CONFIG                                                */
+/************************************************************************/
+void app_read_REG_SUPERVISOR_CONFIG(void)
+{
+}
+
+bool app_write_REG_SUPERVISOR_CONFIG(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!supervisor_set_config(reg[0], reg[1], reg[2])) return false;
+	
+	app_regs.REG_SUPERVISOR_CONFIG[0] = reg[0];
+	app_regs.REG_SUPERVISOR_CONFIG[1] = reg[1];
+	app_regs.REG_SUPERVISOR_CONFIG[2] = reg[2];
+	return true;
+}
+
+/************************************************************************/
+/* REG_SUPERVISOR_CONTROL                                               */
+/************************************************************************/
+extern bool supervisor_is_enabled;
+extern bool supervisor_corrects;
+extern bool supervisor_stalled;
+
+void app_read_REG_SUPERVISOR_CONTROL(void)
+{
+	uint8_t temp = 0;
+	
+	if (supervisor_is_enabled) temp |= REG_SUPERVISOR_CONTROL_B_ENABLE;
+	if (supervisor_corrects) temp |= REG_SUPERVISOR_CONTROL_B_CORRECT;
+	if (supervisor_stalled) temp |= REG_SUPERVISOR_CONTROL_B_STALLED;
+	
+	app_regs.REG_SUPERVISOR_CONTROL = temp;
+}
+
+bool app_write_REG_SUPERVISOR_CONTROL(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	supervisor_enable((reg & REG_SUPERVISOR_CONTROL_B_ENABLE) ? true : false, (reg & REG_SUPERVISOR_CONTROL_B_CORRECT) ? true : false);
+	
+	app_read_REG_SUPERVISOR_CONTROL();
+	return true;
+}
+
+/************************************************************************/
+/* REG_FOLLOWING_ERROR                                                  */
+/************************************************************************/
+void app_read_REG_FOLLOWING_ERROR(void)
+{
+	app_regs.REG_FOLLOWING_ERROR = supervisor_get_following_error();
+}
+
+bool app_write_REG_FOLLOWING_ERROR(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_AUTOTUNE_CONFIG                                                  */
+/************************************************************************/
+void app_read_REG_AUTOTUNE_CONFIG(void)
+{
+}
+
+bool app_write_REG_AUTOTUNE_CONFIG(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!autotune_set_config(reg[0], reg[1], reg[2], reg[3])) return false;
+	
+	app_regs.REG_AUTOTUNE_CONFIG[0] = reg[0];
+	app_regs.REG_AUTOTUNE_CONFIG[1] = reg[1];
+	app_regs.REG_AUTOTUNE_CONFIG[2] = reg[2];
+	app_regs.REG_AUTOTUNE_CONFIG[3] = reg[3];
+	return true;
+}
+
+/************************************************************************/
+/* REG_AUTOTUNE_CONTROL                                                 */
+/************************************************************************/
+extern bool autotune_is_done;
+extern bool autotune_failed;
+extern bool jog_is_active;
+
+void app_read_REG_AUTOTUNE_CONTROL(void)
+{
+	uint8_t temp = 0;
+	
+	if (autotune_is_running) temp |= REG_AUTOTUNE_CONTROL_B_RUNNING;
+	if (autotune_is_done) temp |= REG_AUTOTUNE_CONTROL_B_DONE;
+	if (autotune_failed) temp |= REG_AUTOTUNE_CONTROL_B_FAILED;
+	
+	app_regs.REG_AUTOTUNE_CONTROL = temp;
+}
+
+bool app_write_REG_AUTOTUNE_CONTROL(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg & REG_AUTOTUNE_CONTROL_B_ABORT)
+	{
+		autotune_abort();
+	}
+	else if (reg & REG_AUTOTUNE_CONTROL_B_START)
+	{
+		// The trial movements need the motor for themselves
+		if (motor_is_taken() || jog_is_active) return false;
+		if (!autotune_start()) return false;
+	}
+	
+	app_read_REG_AUTOTUNE_CONTROL();
+	return true;
+}
+
+/************************************************************************/
+/* REG_AUTOTUNE_RESULT                                                  */
+/************************************************************************/
+void app_read_REG_AUTOTUNE_RESULT(void)
+{
+	autotune_get_result(app_regs.REG_AUTOTUNE_RESULT);
+}
+
+bool app_write_REG_AUTOTUNE_RESULT(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_HOMING_CONFIG                                                    */
+/************************************************************************/
+void app_read_REG_HOMING_CONFIG(void)
+{
+}
+
+bool app_write_REG_HOMING_CONFIG(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!homing_set_config(reg[0], reg[1], reg[2], reg[3])) return false;
+	
+	app_regs.REG_HOMING_CONFIG[0] = reg[0];
+	app_regs.REG_HOMING_CONFIG[1] = reg[1];
+	app_regs.REG_HOMING_CONFIG[2] = reg[2];
+	app_regs.REG_HOMING_CONFIG[3] = reg[3];
+	return true;
+}
+
+/************************************************************************/
+/* REG_HOMING_PHASE                                                     */
+/************************************************************************/
+void app_read_REG_HOMING_PHASE(void)
+{
+	app_regs.REG_HOMING_PHASE = homing_get_phase();
+}
+
+bool app_write_REG_HOMING_PHASE(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_HOME_SWITCH_LATCH                                                */
+/************************************************************************/
+void app_read_REG_HOME_SWITCH_LATCH(void)
+{
+}
+
+bool app_write_REG_HOME_SWITCH_LATCH(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_STOP_LATENCY                                                     */
+/************************************************************************/
+extern uint16_t emergency_stop_latency;
+
+void app_read_REG_STOP_LATENCY(void)
+{
+	app_regs.REG_STOP_LATENCY = emergency_stop_latency;
+}
+
+bool app_write_REG_STOP_LATENCY(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_COMPARE_CONTROL                                                  */
+/************************************************************************/
+void app_read_REG_COMPARE_CONTROL(void)
+{
+}
+
+bool app_write_REG_COMPARE_CONTROL(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (!position_compare_enable(reg & (REG_COMPARE_CONTROL_B_OUTPUT_0 | REG_COMPARE_CONTROL_B_OUTPUT_1), (reg >> 2) & 0x03)) return false;
+	
+	app_regs.REG_COMPARE_CONTROL = reg & 0x0F;
+	return true;
+}
+
+/************************************************************************/
+/* REG_COMPARE_CONFIG_0                                                 */
+/************************************************************************/
+void app_read_REG_COMPARE_CONFIG_0(void)
+{
+}
+
+bool app_write_REG_COMPARE_CONFIG_0(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!position_compare_set_config(0, reg[0], reg[1], reg[2])) return false;
+	
+	app_regs.REG_COMPARE_CONFIG_0[0] = reg[0];
+	app_regs.REG_COMPARE_CONFIG_0[1] = reg[1];
+	app_regs.REG_COMPARE_CONFIG_0[2] = reg[2];
+	return true;
+}
+
+/************************************************************************/
+/* REG_COMPARE_CONFIG_1                                                 */
+/************************************************************************/
+void app_read_REG_COMPARE_CONFIG_1(void)
+{
+}
+
+bool app_write_REG_COMPARE_CONFIG_1(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!position_compare_set_config(1, reg[0], reg[1], reg[2])) return false;
+	
+	app_regs.REG_COMPARE_CONFIG_1[0] = reg[0];
+	app_regs.REG_COMPARE_CONFIG_1[1] = reg[1];
+	app_regs.REG_COMPARE_CONFIG_1[2] = reg[2];
+	return true;
+}
+
+/************************************************************************/
+/* REG_COMPARE_TABLE                                                    */
+/************************************************************************/
+void app_read_REG_COMPARE_TABLE(void)
+{
+}
+
+bool app_write_REG_COMPARE_TABLE(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!position_compare_set_table(reg)) return false;
+	
+	for (uint8_t i = 0; i < COMPARE_TABLE_SIZE; i++)
+		app_regs.REG_COMPARE_TABLE[i] = reg[i];
+	return true;
+}
+
+/************************************************************************/
+/* REG_COMPARE_PULSE_WIDTH                                              */
+/************************************************************************/
+void app_read_REG_COMPARE_PULSE_WIDTH(void)
+{
+}
+
+bool app_write_REG_COMPARE_PULSE_WIDTH(void *a)
+{
+	uint16_t reg = *((uint16_t*)a);
+	
+	if (!position_compare_set_pulse_width(reg)) return false;
+	
+	app_regs.REG_COMPARE_PULSE_WIDTH = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_WAYPOINTS                                                        */
+/************************************************************************/
+void app_read_REG_WAYPOINTS(void)
+{
+}
+
+bool app_write_REG_WAYPOINTS(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	if (!waypoints_set(reg, app_regs.REG_WAYPOINT_COUNT)) return false;
+	
+	for (uint8_t i = 0; i < WAYPOINTS_SIZE; i++)
+		app_regs.REG_WAYPOINTS[i] = reg[i];
+	return true;
+}
+
+/************************************************************************/
+/* REG_WAYPOINT_COUNT                                                   */
+/************************************************************************/
+void app_read_REG_WAYPOINT_COUNT(void)
+{
+}
+
+bool app_write_REG_WAYPOINT_COUNT(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (!waypoints_set(app_regs.REG_WAYPOINTS, reg)) return false;
+	
+	app_regs.REG_WAYPOINT_COUNT = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_WAYPOINT_EVENT                                                   */
+/************************************************************************/
+void app_read_REG_WAYPOINT_EVENT(void)
+{
+}
+
+bool app_write_REG_WAYPOINT_EVENT(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_PRESET_MOVE_TO                                                   */
+/************************************************************************/
+static void prepare_move_presets(int32_t *targets, uint8_t relative)
+{
+	// Each preset is swapped in one go, so a trigger never sees a half planned movement
+	for (uint8_t i = 0; i < MOVE_PRESETS_COUNT; i++)
+		prepare_move_preset(i + 1, targets[i], (relative & (1 << i)) ? true : false);
+}
+
+void app_read_REG_PRESET_MOVE_TO(void)
+{
+}
+
+bool app_write_REG_PRESET_MOVE_TO(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	prepare_move_presets(reg, app_regs.REG_PRESET_RELATIVE);
+	
+	for (uint8_t i = 0; i < MOVE_PRESETS_COUNT; i++)
+		app_regs.REG_PRESET_MOVE_TO[i] = reg[i];
+	return true;
+}
+
+/************************************************************************/
+/* REG_PRESET_RELATIVE                                                  */
+/************************************************************************/
+void app_read_REG_PRESET_RELATIVE(void)
+{
+}
+
+bool app_write_REG_PRESET_RELATIVE(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg & ~((1 << MOVE_PRESETS_COUNT) - 1)) return false;
+	
+	prepare_move_presets(app_regs.REG_PRESET_MOVE_TO, reg);
+	
+	app_regs.REG_PRESET_RELATIVE = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_PRESET_START                                                     */
+/************************************************************************/
+void app_read_REG_PRESET_START(void)
+{
+}
+
+bool app_write_REG_PRESET_START(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg > MOVE_PRESETS_COUNT) return false;
+	
+	// Same restrictions as REG_MOVE_TO (checked again by start_move_preset), but started right away instead of on the next 1 ms tick
+	if (motor_is_taken()) return false;
+	start_move_preset(reg);
+	
+	app_regs.REG_PRESET_START = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_TRIGGER_PRESET                                                   */
+/************************************************************************/
+void app_read_REG_TRIGGER_PRESET(void)
+{
+}
+
+bool app_write_REG_TRIGGER_PRESET(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (!set_trigger_preset(reg)) return false;
+	
+	app_regs.REG_TRIGGER_PRESET = reg;
+	return true;
+}
+
+/************************************************************************/
+/* REG_SEQUENCE                                                         */
+/************************************************************************/
+extern bool sequence_is_running;
+extern bool sequence_is_done;
+extern bool sequence_failed;
+
+void app_read_REG_SEQUENCE(void)
+{
+}
+
+bool app_write_REG_SEQUENCE(void *a)
+{
+	int32_t *reg = ((int32_t*)a);
+	
+	// The sequence runs from this register, so it can't change under it
+	if (sequence_is_running || !sequence_is_valid(reg)) return false;
+	
+	for (uint8_t i = 0; i < SEQUENCE_SIZE; i++)
+		app_regs.REG_SEQUENCE[i] = reg[i];
+	return true;
+}
+
+/************************************************************************/
+/* REG_SEQUENCE_CONTROL                                                 */
+/************************************************************************/
+void app_read_REG_SEQUENCE_CONTROL(void)
+{
+	uint8_t temp = 0;
+	
+	if (sequence_is_running) temp |= REG_SEQUENCE_CONTROL_B_RUNNING;
+	if (sequence_is_done) temp |= REG_SEQUENCE_CONTROL_B_DONE;
+	if (sequence_failed) temp |= REG_SEQUENCE_CONTROL_B_FAILED;
+	
+	app_regs.REG_SEQUENCE_CONTROL = temp;
+}
+
+bool app_write_REG_SEQUENCE_CONTROL(void *a)
+{
+	uint8_t reg = *((uint8_t*)a);
+	
+	if (reg & REG_SEQUENCE_CONTROL_B_ABORT)
+	{
+		sequence_abort();
+	}
+	else if (reg & REG_SEQUENCE_CONTROL_B_START)
+	{
+		// The sequence moves the motor, so it can't start while another mode has control of it
+		if (motor_is_taken()) return false;
+		if (!sequence_start(app_regs.REG_SEQUENCE)) return false;
+	}
+	
+	app_read_REG_SEQUENCE_CONTROL();
+	return true;
+}
+
+/************************************************************************/
+/* REG_SEQUENCE_INDEX                                                   */
+/************************************************************************/
+void app_read_REG_SEQUENCE_INDEX(void)
+{
+	app_regs.REG_SEQUENCE_INDEX = sequence_get_index();
+}
+
+bool app_write_REG_SEQUENCE_INDEX(void *a)
+{
+	return false;
+}
+
+/************************************************************************/
+/* REG_BINARY_LINK_ERRORS                                               */
+/************************************************************************/
+extern uint16_t binary_link_crc_errors;
+extern uint16_t binary_link_line_errors;
+
+void app_read_REG_BINARY_LINK_ERRORS(void)
+{
+	app_regs.REG_BINARY_LINK_ERRORS[0] = binary_link_crc_errors;
+	app_regs.REG_BINARY_LINK_ERRORS[1] = binary_link_line_errors;
+}
+
+bool app_write_REG_BINARY_LINK_ERRORS(void *a)
+{
+	return false;
+}
@@ -49,6 +49,82 @@ void app_read_REG_HOME_STEPS(void);
 void app_read_REG_HOME_STEPS_EVENTS(void);
 void app_read_REG_HOME_VELOCITY(void);
 void app_read_REG_HOME_SWITCH(void);
+/* Synchronized sampling */
+void app_read_REG_FRAME(void);
+void app_read_REG_FRAME_PERIOD(void);
+/* Trace capture */
+void app_read_REG_TRACE_CONTROL(void);
+void app_read_REG_TRACE_SIGNALS(void);
+void app_read_REG_TRACE_DECIMATION(void);
+void app_read_REG_TRACE_COUNT(void);
+void app_read_REG_TRACE_READ_INDEX(void);
+void app_read_REG_TRACE_DATA(void);
+/* Position */
+void app_read_REG_POSITION(void);
+void app_read_REG_POSITION_EVENT_PERIOD(void);
+/* Scheduled movement */
+void app_read_REG_MOVE_AT(void);
+void app_read_REG_MOVE_AT_ERROR(void);
+/* Triggered movement */
+void app_read_REG_DIGITAL_INPUTS(void);
+void app_read_REG_TRIGGER_CONFIG(void);
+void app_read_REG_TRIGGER_MOVE_TO(void);
+/* Streamed movement */
+void app_read_REG_PVT_POINT(void);
+void app_read_REG_PVT_CONTROL(void);
+void app_read_REG_PVT_FILL_LEVEL(void);
+/* Motion profile */
+void app_read_REG_MOTION_PROFILE(void);
+/* Move report */
+void app_read_REG_MOVE_REPORT(void);
+/* Quick stop */
+void app_read_REG_QUICK_STOP_DECELERATION(void);
+void app_read_REG_QUICK_STOP_JERK(void);
+/* Feed override */
+void app_read_REG_FEED_OVERRIDE(void);
+/* Position limits */
+void app_read_REG_POSITION_LIMITS(void);
+void app_read_REG_POSITION_LIMIT_EVENTS(void);
+/* Electronic gearing */
+void app_read_REG_GEAR_RATIO(void);
+void app_read_REG_GEARING_CONTROL(void);
+/* Analog following */
+void app_read_REG_ANALOG_FOLLOW_CONFIG(void);
+/* Encoder supervisor */
+void app_read_REG_SUPERVISOR_CONFIG(void);
+void app_read_REG_SUPERVISOR_CONTROL(void);
+void app_read_REG_FOLLOWING_ERROR(void);
+/* Acceleration auto-tune */
+void app_read_REG_AUTOTUNE_CONFIG(void);
+void app_read_REG_AUTOTUNE_CONTROL(void);
+void app_read_REG_AUTOTUNE_RESULT(void);
+/* Homing */
+void app_read_REG_HOMING_CONFIG(void);
+void app_read_REG_HOMING_PHASE(void);
+void app_read_REG_HOME_SWITCH_LATCH(void);
+/* Emergency stop */
+void app_read_REG_STOP_LATENCY(void);
+/* Position compare */
+void app_read_REG_COMPARE_CONTROL(void);
+void app_read_REG_COMPARE_CONFIG_0(void);
+void app_read_REG_COMPARE_CONFIG_1(void);
+void app_read_REG_COMPARE_TABLE(void);
+void app_read_REG_COMPARE_PULSE_WIDTH(void);
+/* Waypoints */
+void app_read_REG_WAYPOINTS(void);
+void app_read_REG_WAYPOINT_COUNT(void);
+void app_read_REG_WAYPOINT_EVENT(void);
+/* Move presets */
+void app_read_REG_PRESET_MOVE_TO(void);
+void app_read_REG_PRESET_RELATIVE(void);
+void app_read_REG_PRESET_START(void);
+void app_read_REG_TRIGGER_PRESET(void);
+/* Sequencer */
+void app_read_REG_SEQUENCE(void);
+void app_read_REG_SEQUENCE_CONTROL(void);
+void app_read_REG_SEQUENCE_INDEX(void);
+/* Binary link */
+void app_read_REG_BINARY_LINK_ERRORS(void);
 
 
 /* Register write functions */
@@ -79,5 +155,81 @@ bool app_write_REG_HOME_STEPS(void *a);
 bool app_write_REG_HOME_STEPS_EVENTS(void *a);
 bool app_write_REG_HOME_VELOCITY(void *a);
 bool app_write_REG_HOME_SWITCH(void *a);
+/* Synchronized sampling */
+bool app_write_REG_FRAME(void *a);
+bool app_write_REG_FRAME_PERIOD(void *a);
+/* Trace capture */
+bool app_write_REG_TRACE_CONTROL(void *a);
+bool app_write_REG_TRACE_SIGNALS(void *a);
+bool app_write_REG_TRACE_DECIMATION(void *a);
+bool app_write_REG_TRACE_COUNT(void *a);
+bool app_write_REG_TRACE_READ_INDEX(void *a);
+bool app_write_REG_TRACE_DATA(void *a);
+/* Position */
+bool app_write_REG_POSITION(void *a);
+bool app_write_REG_POSITION_EVENT_PERIOD(void *a);
+/* Scheduled movement */
+bool app_write_REG_MOVE_AT(void *a);
+bool app_write_REG_MOVE_AT_ERROR(void *a);
+/* Triggered movement */
+bool app_write_REG_DIGITAL_INPUTS(void *a);
+bool app_write_REG_TRIGGER_CONFIG(void *a);
+bool app_write_REG_TRIGGER_MOVE_TO(void *a);
+/* Streamed movement */
+bool app_write_REG_PVT_POINT(void *a);
+bool app_write_REG_PVT_CONTROL(void *a);
+bool app_write_REG_PVT_FILL_LEVEL(void *a);
+/* Motion profile */
+bool app_write_REG_MOTION_PROFILE(void *a);
+/* Move report */
+bool app_write_REG_MOVE_REPORT(void *a);
+/* Quick stop */
+bool app_write_REG_QUICK_STOP_DECELERATION(void *a);
+bool app_write_REG_QUICK_STOP_JERK(void *a);
+/* Feed override */
+bool app_write_REG_FEED_OVERRIDE(void *a);
+/* Position limits */
+bool app_write_REG_POSITION_LIMITS(void *a);
+bool app_write_REG_POSITION_LIMIT_EVENTS(void *a);
+/* Electronic gearing */
+bool app_write_REG_GEAR_RATIO(void *a);
+bool app_write_REG_GEARING_CONTROL(void *a);
+/* Analog following */
+bool app_write_REG_ANALOG_FOLLOW_CONFIG(void *a);
+/* Encoder supervisor */
+bool app_write_REG_SUPERVISOR_CONFIG(void *a);
+bool app_write_REG_SUPERVISOR_CONTROL(void *a);
+bool app_write_REG_FOLLOWING_ERROR(void *a);
+/* Acceleration auto-tune */
+bool app_write_REG_AUTOTUNE_CONFIG(void *a);
+bool app_write_REG_AUTOTUNE_CONTROL(void *a);
+bool app_write_REG_AUTOTUNE_RESULT(void *a);
+/* Homing */
+bool app_write_REG_HOMING_CONFIG(void *a);
+bool app_write_REG_HOMING_PHASE(void *a);
+bool app_write_REG_HOME_SWITCH_LATCH(void *a);
+/* Emergency stop */
+bool app_write_REG_STOP_LATENCY(void *a);
+/* Position compare */
+bool app_write_REG_COMPARE_CONTROL(void *a);
+bool app_write_REG_COMPARE_CONFIG_0(void *a);
+bool app_write_REG_COMPARE_CONFIG_1(void *a);
+bool app_write_REG_COMPARE_TABLE(void *a);
+bool app_write_REG_COMPARE_PULSE_WIDTH(void *a);
+/* Waypoints */
+bool app_write_REG_WAYPOINTS(void *a);
+bool app_write_REG_WAYPOINT_COUNT(void *a);
+bool app_write_REG_WAYPOINT_EVENT(void *a);
+/* Move presets */
+bool app_write_REG_PRESET_MOVE_TO(void *a);
+bool app_write_REG_PRESET_RELATIVE(void *a);
+bool app_write_REG_PRESET_START(void *a);
+bool app_write_REG_TRIGGER_PRESET(void *a);
+/* Sequencer */
+bool app_write_REG_SEQUENCE(void *a);
+bool app_write_REG_SEQUENCE_CONTROL(void *a);
+bool app_write_REG_SEQUENCE_INDEX(void *a);
+/* Binary link */
+bool app_write_REG_BINARY_LINK_ERRORS(void *a);
 
 #endif /* _APP_FUNCTIONS_H_ */
\ No newline at end of file
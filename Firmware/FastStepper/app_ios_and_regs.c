@@ -7,12 +7,16 @@
 /************************************************************************/
 void init_ios(void)
 {	/* Configure input pins */
-	io_pin2in(&PORTB, 0, PULL_IO_TRISTATE, SENSE_IO_EDGES_BOTH);         // STOP_SWITCH
+	io_pin2in(&PORTB, 0, PULL_IO_TRISTATE, SENSE_IO_EDGE_FALLING);       // STOP_SWITCH (release is polled, see emergency_stop.h)
 	io_pin2in(&PORTD, 2, PULL_IO_TRISTATE, SENSE_IO_EDGES_BOTH);         // RX
 	io_pin2in(&PORTC, 7, PULL_IO_TRISTATE, SENSE_IO_EDGES_BOTH);         // ENDSTOP_SWITCH
+	io_pin2in(&PORTD, 5, PULL_IO_TRISTATE, SENSE_IO_EDGES_BOTH);         // INPUT_0
+	io_pin2in(&PORTD, 6, PULL_IO_TRISTATE, SENSE_IO_EDGES_BOTH);         // INPUT_1
 
 	/* Configure input interrupts */
 	io_set_int(&PORTB, INT_LEVEL_LOW, 0, (1<<0), false);                 // STOP_SWITCH
+	io_set_int(&PORTD, INT_LEVEL_HIGH, 0, (1<<5) | (1<<6), false);       // INPUT_0, INPUT_1
+	io_set_int(&PORTC, INT_LEVEL_MED, 0, (1<<7), false);                 // ENDSTOP_SWITCH
 
 	/* Configure output pins */
 	io_pin2out(&PORTC, 3, OUT_IO_DIGITAL, IN_EN_IO_EN);                  // MOTOR_ENABLE
@@ -66,7 +70,83 @@ uint8_t app_regs_type[] = {
 	TYPE_I32,
 	TYPE_U8,
 	TYPE_U32,
-	TYPE_U8
+	TYPE_U8,
+	/* Synchronized sampling */
+	TYPE_I32,
+	TYPE_U16,
+	/* Trace capture */
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_U16,
+	TYPE_U16,
+	TYPE_U16,
+	/* Position */
+	TYPE_I32,
+	TYPE_U16,
+	/* Scheduled movement */
+	TYPE_I32,
+	TYPE_I32,
+	/* Triggered movement */
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_I32,
+	/* Streamed movement */
+	TYPE_I32,
+	TYPE_U8,
+	TYPE_U8,
+	/* Motion profile */
+	TYPE_I32,
+	/* Move report */
+	TYPE_I32,
+	/* Quick stop */
+	TYPE_I32,
+	TYPE_I32,
+	/* Feed override */
+	TYPE_U8,
+	/* Position limits */
+	TYPE_I32,
+	TYPE_U8,
+	/* Electronic gearing */
+	TYPE_I16,
+	TYPE_U8,
+	/* Analog following */
+	TYPE_I32,
+	/* Encoder supervisor */
+	TYPE_I32,
+	TYPE_U8,
+	TYPE_I32,
+	/* Acceleration auto-tune */
+	TYPE_I32,
+	TYPE_U8,
+	TYPE_I32,
+	/* Homing */
+	TYPE_I32,
+	TYPE_U8,
+	TYPE_I32,
+	/* Emergency stop */
+	TYPE_U16,
+	/* Position compare */
+	TYPE_U8,
+	TYPE_I32,
+	TYPE_I32,
+	TYPE_I32,
+	TYPE_U16,
+	/* Waypoints */
+	TYPE_I32,
+	TYPE_U8,
+	TYPE_I32,
+	/* Move presets */
+	TYPE_I32,
+	TYPE_U8,
+	TYPE_U8,
+	TYPE_U8,
+	/* Sequencer */
+	TYPE_I32,
+	TYPE_U8,
+	TYPE_U8,
+	/* Binary link */
+	TYPE_U16
 };
 
 uint16_t app_regs_n_elements[] = {
@@ -89,7 +169,61 @@ uint16_t app_regs_n_elements[] = {
 	1,
 	1,
 	1,
-	1
+	1,
+	5,
+	1,
+	1,
+	1,
+	1,
+	1,
+	1,
+	32,
+	1,
+	1,
+	3,
+	1,
+	1,
+	1,
+	1,
+	3,
+	1,
+	1,
+	6,
+	5,
+	1,
+	1,
+	1,
+	2,
+	1,
+	2,
+	1,
+	5,
+	3,
+	1,
+	1,
+	4,
+	1,
+	3,
+	4,
+	1,
+	3,
+	1,
+	1,
+	3,
+	3,
+	8,
+	1,
+	8,
+	1,
+	4,
+	4,
+	1,
+	1,
+	1,
+	16,
+	1,
+	1,
+	2
 };
 
 
@@ -119,5 +253,81 @@ uint8_t *app_regs_pointer[] = {
 	(uint8_t*)(&app_regs.REG_HOME_STEPS),
 	(uint8_t*)(&app_regs.REG_HOME_STEPS_EVENTS),
 	(uint8_t*)(&app_regs.REG_HOME_VELOCITY),
-	(uint8_t*)(&app_regs.REG_HOME_SWITCH)
+	(uint8_t*)(&app_regs.REG_HOME_SWITCH),
+	/* Synchronized sampling */
+	(uint8_t*)(app_regs.REG_FRAME),
+	(uint8_t*)(&app_regs.REG_FRAME_PERIOD),
+	/* Trace capture */
+	(uint8_t*)(&app_regs.REG_TRACE_CONTROL),
+	(uint8_t*)(&app_regs.REG_TRACE_SIGNALS),
+	(uint8_t*)(&app_regs.REG_TRACE_DECIMATION),
+	(uint8_t*)(&app_regs.REG_TRACE_COUNT),
+	(uint8_t*)(&app_regs.REG_TRACE_READ_INDEX),
+	(uint8_t*)(app_regs.REG_TRACE_DATA),
+	/* Position */
+	(uint8_t*)(&app_regs.REG_POSITION),
+	(uint8_t*)(&app_regs.REG_POSITION_EVENT_PERIOD),
+	/* Scheduled movement */
+	(uint8_t*)(app_regs.REG_MOVE_AT),
+	(uint8_t*)(&app_regs.REG_MOVE_AT_ERROR),
+	/* Triggered movement */
+	(uint8_t*)(&app_regs.REG_DIGITAL_INPUTS),
+	(uint8_t*)(&app_regs.REG_TRIGGER_CONFIG),
+	(uint8_t*)(&app_regs.REG_TRIGGER_MOVE_TO),
+	/* Streamed movement */
+	(uint8_t*)(app_regs.REG_PVT_POINT),
+	(uint8_t*)(&app_regs.REG_PVT_CONTROL),
+	(uint8_t*)(&app_regs.REG_PVT_FILL_LEVEL),
+	/* Motion profile */
+	(uint8_t*)(app_regs.REG_MOTION_PROFILE),
+	/* Move report */
+	(uint8_t*)(app_regs.REG_MOVE_REPORT),
+	/* Quick stop */
+	(uint8_t*)(&app_regs.REG_QUICK_STOP_DECELERATION),
+	(uint8_t*)(&app_regs.REG_QUICK_STOP_JERK),
+	/* Feed override */
+	(uint8_t*)(&app_regs.REG_FEED_OVERRIDE),
+	/* Position limits */
+	(uint8_t*)(app_regs.REG_POSITION_LIMITS),
+	(uint8_t*)(&app_regs.REG_POSITION_LIMIT_EVENTS),
+	/* Electronic gearing */
+	(uint8_t*)(app_regs.REG_GEAR_RATIO),
+	(uint8_t*)(&app_regs.REG_GEARING_CONTROL),
+	/* Analog following */
+	(uint8_t*)(app_regs.REG_ANALOG_FOLLOW_CONFIG),
+	/* Encoder supervisor */
+	(uint8_t*)(app_regs.REG_SUPERVISOR_CONFIG),
+	(uint8_t*)(&app_regs.REG_SUPERVISOR_CONTROL),
+	(uint8_t*)(&app_regs.REG_FOLLOWING_ERROR),
+	/* Acceleration auto-tune */
+	(uint8_t*)(app_regs.REG_AUTOTUNE_CONFIG),
+	(uint8_t*)(&app_regs.REG_AUTOTUNE_CONTROL),
+	(uint8_t*)(app_regs.REG_AUTOTUNE_RESULT),
+	/* Homing */
+	(uint8_t*)(app_regs.REG_HOMING_CONFIG),
+	(uint8_t*)(&app_regs.REG_HOMING_PHASE),
+	(uint8_t*)(app_regs.REG_HOME_SWITCH_LATCH),
+	/* Emergency stop */
+	(uint8_t*)(&app_regs.REG_STOP_LATENCY),
+	/* Position compare */
+	(uint8_t*)(&app_regs.REG_COMPARE_CONTROL),
+	(uint8_t*)(app_regs.REG_COMPARE_CONFIG_0),
+	(uint8_t*)(app_regs.REG_COMPARE_CONFIG_1),
+	(uint8_t*)(app_regs.REG_COMPARE_TABLE),
+	(uint8_t*)(&app_regs.REG_COMPARE_PULSE_WIDTH),
+	/* Waypoints */
+	(uint8_t*)(app_regs.REG_WAYPOINTS),
+	(uint8_t*)(&app_regs.REG_WAYPOINT_COUNT),
+	(uint8_t*)(app_regs.REG_WAYPOINT_EVENT),
+	/* Move presets */
+	(uint8_t*)(app_regs.REG_PRESET_MOVE_TO),
+	(uint8_t*)(&app_regs.REG_PRESET_RELATIVE),
+	(uint8_t*)(&app_regs.REG_PRESET_START),
+	(uint8_t*)(&app_regs.REG_TRIGGER_PRESET),
+	/* Sequencer */
+	(uint8_t*)(app_regs.REG_SEQUENCE),
+	(uint8_t*)(&app_regs.REG_SEQUENCE_CONTROL),
+	(uint8_t*)(&app_regs.REG_SEQUENCE_INDEX),
+	/* Binary link */
+	(uint8_t*)(app_regs.REG_BINARY_LINK_ERRORS)
 };
\ No newline at end of file
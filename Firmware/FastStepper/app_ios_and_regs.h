@@ -16,6 +16,12 @@ void init_ios(void);
 #define read_HOME_SWITCH read_io(PORTC, 7)		// HOME_SWITCH
 
 
+// INPUT_0, INPUT_1      Description: Generic digital inputs, used to trigger movements
+
+#define read_INPUT_0 read_io(PORTD, 5)          // INPUT_0
+#define read_INPUT_1 read_io(PORTD, 6)          // INPUT_1
+
+
 
 /************************************************************************/
 /* Definition of output pins                                            */
@@ -92,6 +98,82 @@ typedef struct
 	uint8_t REG_HOME_STEPS_EVENTS;
 	uint32_t REG_HOME_VELOCITY;
 	uint8_t REG_HOME_SWITCH;
+	/* Synchronized sampling */
+	int32_t REG_FRAME[5];
+	uint16_t REG_FRAME_PERIOD;
+	/* Trace capture */
+	uint8_t REG_TRACE_CONTROL;
+	uint8_t REG_TRACE_SIGNALS;
+	uint8_t REG_TRACE_DECIMATION;
+	uint16_t REG_TRACE_COUNT;
+	uint16_t REG_TRACE_READ_INDEX;
+	uint16_t REG_TRACE_DATA[32];
+	/* Position */
+	int32_t REG_POSITION;
+	uint16_t REG_POSITION_EVENT_PERIOD;
+	/* Scheduled movement */
+	int32_t REG_MOVE_AT[3];
+	int32_t REG_MOVE_AT_ERROR;
+	/* Triggered movement */
+	uint8_t REG_DIGITAL_INPUTS;
+	uint8_t REG_TRIGGER_CONFIG;
+	int32_t REG_TRIGGER_MOVE_TO;
+	/* Streamed movement */
+	int32_t REG_PVT_POINT[3];
+	uint8_t REG_PVT_CONTROL;
+	uint8_t REG_PVT_FILL_LEVEL;
+	/* Motion profile */
+	int32_t REG_MOTION_PROFILE[6];
+	/* Move report */
+	int32_t REG_MOVE_REPORT[5];
+	/* Quick stop */
+	int32_t REG_QUICK_STOP_DECELERATION;
+	int32_t REG_QUICK_STOP_JERK;
+	/* Feed override */
+	uint8_t REG_FEED_OVERRIDE;
+	/* Position limits */
+	int32_t REG_POSITION_LIMITS[2];
+	uint8_t REG_POSITION_LIMIT_EVENTS;
+	/* Electronic gearing */
+	int16_t REG_GEAR_RATIO[2];
+	uint8_t REG_GEARING_CONTROL;
+	/* Analog following */
+	int32_t REG_ANALOG_FOLLOW_CONFIG[5];
+	/* Encoder supervisor */
+	int32_t REG_SUPERVISOR_CONFIG[3];
+	uint8_t REG_SUPERVISOR_CONTROL;
+	int32_t REG_FOLLOWING_ERROR;
+	/* Acceleration auto-tune */
+	int32_t REG_AUTOTUNE_CONFIG[4];
+	uint8_t REG_AUTOTUNE_CONTROL;
+	int32_t REG_AUTOTUNE_RESULT[3];
+	/* Homing */
+	int32_t REG_HOMING_CONFIG[4];
+	uint8_t REG_HOMING_PHASE;
+	int32_t REG_HOME_SWITCH_LATCH[3];
+	/* Emergency stop */
+	uint16_t REG_STOP_LATENCY;
+	/* Position compare */
+	uint8_t REG_COMPARE_CONTROL;
+	int32_t REG_COMPARE_CONFIG_0[3];
+	int32_t REG_COMPARE_CONFIG_1[3];
+	int32_t REG_COMPARE_TABLE[8];
+	uint16_t REG_COMPARE_PULSE_WIDTH;
+	/* Waypoints */
+	int32_t REG_WAYPOINTS[8];
+	uint8_t REG_WAYPOINT_COUNT;
+	int32_t REG_WAYPOINT_EVENT[4];
+	/* Move presets */
+	int32_t REG_PRESET_MOVE_TO[4];
+	uint8_t REG_PRESET_RELATIVE;
+	uint8_t REG_PRESET_START;
+	uint8_t REG_TRIGGER_PRESET;
+	/* Sequencer */
+	int32_t REG_SEQUENCE[16];
+	uint8_t REG_SEQUENCE_CONTROL;
+	uint8_t REG_SEQUENCE_INDEX;
+	/* Binary link */
+	uint16_t REG_BINARY_LINK_ERRORS[2];
 
 } AppRegs;
 
@@ -109,8 +191,8 @@ typedef struct
 #define ADD_REG_MOVING		                37 // U8     Contains the state of the motor movement.
 
 /* Direct motor control */
-#define ADD_REG_STOP_MOVEMENT               38 // U8     Instantly stops the motor movement.
-#define ADD_REG_DIRECT_VELOCITY             39 // I32    Instantly start moving at a specific speed and direction according to the register's value and signal.
+#define ADD_REG_STOP_MOVEMENT               38 // U8     Stops the motor movement as fast as the quick stop deceleration allows.
+#define ADD_REG_DIRECT_VELOCITY             39 // I32    Ramps to a signed velocity (steps/s) using the acceleration and jerk settings. Writing 0 ramps down to a stop.
 
 /* Accelerated motor control */
 #define ADD_REG_MOVE_TO                     40 // I32    Moves to a specific position, using the velocity, acceleration and jerk configurations.
@@ -119,16 +201,114 @@ typedef struct
 #define ADD_REG_MAX_VELOCITY                43 // U16    Sets the maximum velocity for the movement (steps/s)
 #define ADD_REG_ACCELERATION                44 // I32    Sets the acceleration for the movement (steps/s^2)
 #define ADD_REG_DECELERATION                45 // I32    Sets the acceleration for the movement (steps/s^2)
-#define ADD_REG_ACCELERATION_JERK           46 // I32    Sets the jerk for the acceleration part of the movement (steps/s^3)
+#define ADD_REG_ACCELERATION_JERK           46 // I32    Sets the jerk for the acceleration part of the movement (steps/s^3), negative values are rejected
 #define ADD_REG_DECELERATION_JERK           47 // I32    Sets the jerk for the deceleration part of the movement (steps/s^3)
 
 /* Homing control */
 #define ADD_REG_HOME_STEPS                  48 // I32    Moves a specific number of steps in a direction according to the register's value and signal, attempting to perform a homing routine.											   
 											   // 	     Resets the current position to 0 when the home sensor is hit. The home steps value should be slightly over than the longest possible movement.
 #define ADD_REG_HOME_STEPS_EVENTS           49 // U8     Reports possible events regarding the execution of the REG_HOME_STEPS register.
-#define ADD_REG_HOME_VELOCITY               50 // U32    Sets the fixed velocity for the homing movement (steps/s)
+#define ADD_REG_HOME_VELOCITY               50 // U32    Sets the velocity of the fast approach to the home switch (steps/s). With 0, homing only approaches the switch at the minimum velocity.
 #define ADD_REG_HOME_SWITCH                 51 // U8     Contains the state of the home switch.
 
+/* Synchronized sampling */
+#define ADD_REG_FRAME                       52 // I32[5] Position, encoder, analog input, commanded velocity (steps/s) and status flags captured at the same instant.
+#define ADD_REG_FRAME_PERIOD                53 // U16    Sets the period (ms) at which REG_FRAME events are sent. 0 disables the events.
+
+/* Trace capture */
+#define ADD_REG_TRACE_CONTROL               54 // U8     Arms, starts or stops the trace capture. Reading returns the capture state. An event is sent when a capture finishes.
+#define ADD_REG_TRACE_SIGNALS               55 // U8     Selects the signals recorded on each sample. (bitmask defined below)
+#define ADD_REG_TRACE_DECIMATION            56 // U8     Records one sample every N steps.
+#define ADD_REG_TRACE_COUNT                 57 // U16    Contains the number of words available on the capture buffer.
+#define ADD_REG_TRACE_READ_INDEX            58 // U16    Index of the first word returned by the next read of REG_TRACE_DATA (0 is the oldest word).
+#define ADD_REG_TRACE_DATA                  59 // U16[32] Returns the next block of captured words and advances REG_TRACE_READ_INDEX.
+
+/* Position */
+#define ADD_REG_POSITION                    60 // I32    Contains the current motor position (steps). Writing redefines the current position without moving the motor.
+#define ADD_REG_POSITION_EVENT_PERIOD       61 // U16    Sets the period (ms) at which REG_POSITION events are sent while the position changes. 0 disables the periodic events.
+
+/* Scheduled movement */
+#define ADD_REG_MOVE_AT                     62 // I32[3] Moves to [0] (steps) starting at the Harp timestamp [1] (s) + [2] (us). A negative second cancels the scheduled movement.
+#define ADD_REG_MOVE_AT_ERROR               63 // I32    Difference between the real and the scheduled start time of REG_MOVE_AT (us). An event is sent when the movement starts.
+
+/* Triggered movement */
+#define ADD_REG_DIGITAL_INPUTS              64 // U8     Contains the state of the digital inputs. An event is sent when they change. (bitmask defined below)
+#define ADD_REG_TRIGGER_CONFIG              65 // U8     Selects the input edges that start the REG_TRIGGER_MOVE_TO movement. (bitmask defined below)
+#define ADD_REG_TRIGGER_MOVE_TO             66 // I32    Target (steps) of the movement started by the trigger inputs. Relative to the current position if REG_TRIGGER_CONFIG_B_RELATIVE is set.
+
+/* Streamed movement */
+#define ADD_REG_PVT_POINT                   67 // I32[3] Adds a setpoint to the FIFO: position [0] (steps), velocity [1] (steps/s) and time since the previous setpoint [2] (us, 1 to 65535).
+#define ADD_REG_PVT_CONTROL                 68 // U8     Starts or stops following the streamed setpoints. Reading returns the streaming state. (bitmask defined below)
+#define ADD_REG_PVT_FILL_LEVEL              69 // U8     Contains the number of setpoints on the FIFO. An event is sent each time a setpoint is consumed.
+
+/* Motion profile */
+#define ADD_REG_MOTION_PROFILE              70 // I32[6] Sets the minimum velocity, maximum velocity, acceleration, deceleration, acceleration jerk and deceleration jerk at once. Applied when the motor is stopped.
+
+/* Move report */
+#define ADD_REG_MOVE_REPORT                 71 // I32[5] Contains the timestamp of the last step (seconds, microseconds), duration (us), peak velocity (steps/s) and position error (steps) of the last movement. Sent before each REG_MOVE_TO_EVENTS event.
+
+/* Quick stop */
+#define ADD_REG_QUICK_STOP_DECELERATION     72 // I32    Sets the deceleration used by REG_STOP_MOVEMENT (steps/s^2)
+#define ADD_REG_QUICK_STOP_JERK             73 // I32    Sets the jerk used by REG_STOP_MOVEMENT (steps/s^3)
+
+/* Feed override */
+#define ADD_REG_FEED_OVERRIDE               74 // U8     Scales the speed of the movements to a target and of the streamed setpoints, in percent (1 to 200)
+
+/* Position limits */
+#define ADD_REG_POSITION_LIMITS             75 // I32[2] Sets the minimum and maximum positions allowed while the limits are enabled in REG_CONTROL (steps)
+#define ADD_REG_POSITION_LIMIT_EVENTS       76 // U8     Reports when a position limit is reached or a target is clamped to it (bitmask defined below)
+
+/* Electronic gearing */
+#define ADD_REG_GEAR_RATIO                  77 // I16[2] Sets the motor steps per encoder count as numerator and denominator
+#define ADD_REG_GEARING_CONTROL             78 // U8     Starts or stops following the quadrature encoder. Reading returns the gearing state. (bitmask defined below)
+
+/* Analog following */
+#define ADD_REG_ANALOG_FOLLOW_CONFIG        79 // I32[5] Sets the center (ADC counts), deadband (ADC counts), gain (1/1000 steps/s or steps per ADC count), filter (0 to 7) and position offset (steps) used to follow the analog input
+
+/* Encoder supervisor */
+#define ADD_REG_SUPERVISOR_CONFIG           80 // I32[3] Sets the motor steps per encoder count (numerator, denominator) and the following error that means a stall (steps)
+#define ADD_REG_SUPERVISOR_CONTROL          81 // U8     Enables the comparison of the motor position with the encoder and the correction of missed steps (bitmask defined below)
+#define ADD_REG_FOLLOWING_ERROR             82 // I32    Contains the motor position minus the position measured by the encoder (steps). An event is sent when a stall is detected.
+
+/* Acceleration auto-tune */
+#define ADD_REG_AUTOTUNE_CONFIG             83 // I32[4] Sets the trial movement distance (steps), the first acceleration tested (steps/s^2), the position error that fails a trial (steps) and the margin removed from the results (%)
+#define ADD_REG_AUTOTUNE_CONTROL            84 // U8     Starts or aborts the acceleration auto-tune and contains its status (bitmask defined below)
+#define ADD_REG_AUTOTUNE_RESULT             85 // I32[3] Contains the tuned acceleration (steps/s^2), maximum velocity (steps/s) and acceleration jerk (steps/s^3). An event is sent when the auto-tune ends.
+
+/* Homing */
+#define ADD_REG_HOMING_CONFIG               86 // I32[4] Sets the distance to back off from the home switch (steps) and the timeouts of the fast approach, the back off and the slow approach (ms, 0 disables them)
+#define ADD_REG_HOMING_PHASE                87 // U8     Contains the current phase of the homing (0 idle, 1 fast approach, 2 back off, 3 slow approach). An event is sent when it changes.
+#define ADD_REG_HOME_SWITCH_LATCH           88 // I32[3] Contains the motor position (steps, before homing sets it to 0) and the timestamp (seconds, microseconds) of the last home switch activation. An event is sent when the switch activates.
+
+/* Emergency stop */
+#define ADD_REG_STOP_LATENCY                89 // U16    Contains the time from the last stop switch activation until its interrupt stopped the motor (us, 32 us resolution). The step pulses are cut in hardware at the switch edge. Sent with the REG_STOP_SWITCH event.
+
+/* Position compare */
+#define ADD_REG_COMPARE_CONTROL             90 // U8     Enables the trigger pulses on OUTPUT_0 and OUTPUT_1 at specific motor positions (bitmask defined below)
+#define ADD_REG_COMPARE_CONFIG_0            91 // I32[3] Sets the trigger positions of OUTPUT_0 at first position + k * interval (steps), for a number of triggers (0 for no limit). With the table, only the number of table entries is used.
+#define ADD_REG_COMPARE_CONFIG_1            92 // I32[3] Sets the trigger positions of OUTPUT_1, as REG_COMPARE_CONFIG_0
+#define ADD_REG_COMPARE_TABLE               93 // I32[8] Sets the trigger positions (steps, ascending) of the outputs that use the table
+#define ADD_REG_COMPARE_PULSE_WIDTH         94 // U16    Sets the width of the trigger pulses (us, rounded up to 32 us). A trigger reached while its pulse is still high extends that pulse instead of making a new one.
+
+/* Waypoints */
+#define ADD_REG_WAYPOINTS                   95 // I32[8] Sets the waypoints (steps, ascending) reported when the motor reaches them
+#define ADD_REG_WAYPOINT_COUNT              96 // U8     Sets how many entries of REG_WAYPOINTS are used (0 disables the waypoints)
+#define ADD_REG_WAYPOINT_EVENT              97 // I32[4] Event with the waypoint reached, the direction (1 or -1) and the time of its step (seconds, microseconds)
+
+/* Move presets */
+#define ADD_REG_PRESET_MOVE_TO              98 // I32[4] Targets (steps) of the preset movements 1 to 4, planned as soon as they are written. Saved on the EEPROM with REG_PRESET_RELATIVE and REG_TRIGGER_PRESET.
+#define ADD_REG_PRESET_RELATIVE             99 // U8     Preset movements with a target relative to the position at the start (bit 0 is preset 1)
+#define ADD_REG_PRESET_START                100 // U8     Starts a preset movement right away (0 is the REG_TRIGGER_MOVE_TO movement)
+#define ADD_REG_TRIGGER_PRESET              101 // U8     Selects the preset movement started by the REG_TRIGGER_CONFIG input edges (0 is the REG_TRIGGER_MOVE_TO movement)
+
+/* Sequencer */
+#define ADD_REG_SEQUENCE                    102 // I32[16] Instructions of the motion sequence, an opcode (bits 31-24) and a signed argument (bits 23-0). Can't be written while the sequence runs.
+#define ADD_REG_SEQUENCE_CONTROL            103 // U8     Starts or stops the motion sequence (bitmask defined below). An event is sent when the sequence ends.
+#define ADD_REG_SEQUENCE_INDEX              104 // U8     Contains the instruction being executed by the motion sequence
+
+/* Binary link */
+#define ADD_REG_BINARY_LINK_ERRORS          105 // U16[2] Contains the number of binary link frames dropped because of a wrong CRC and because of a framing error, a receive buffer overflow or a full command queue
+
 
 
 /************************************************************************/
@@ -139,8 +319,8 @@ typedef struct
 /************************************************************************/
 /* Memory limits */
 #define APP_REGS_ADD_MIN                    0x20
-#define APP_REGS_ADD_MAX                    0x33
-#define APP_NBYTES_OF_REG_BANK              53
+#define APP_REGS_ADD_MAX                    0x69
+#define APP_NBYTES_OF_REG_BANK              545
 
 /************************************************************************/
 /* Registers' bits                                                      */
@@ -154,11 +334,30 @@ typedef struct
 #define REG_CONTROL_B_RESET_QUAD_ENCODER               (1<<6)       // 
 #define REG_CONTROL_B_ENABLE_HOMING                    (1<<7)       //
 #define REG_CONTROL_B_DISABLE_HOMING                   (1<<8)       //
+#define REG_CONTROL_B_ENABLE_POSITION_EVENTS           (1<<9)       // Send a REG_POSITION event when the motor stops
+#define REG_CONTROL_B_DISABLE_POSITION_EVENTS          (1<<10)      //
+#define REG_CONTROL_B_ENABLE_POSITION_LIMITS           (1<<11)      // Enforce the positions on REG_POSITION_LIMITS
+#define REG_CONTROL_B_DISABLE_POSITION_LIMITS          (1<<12)      //
+#define REG_CONTROL_B_ENABLE_ANALOG_VELOCITY           (1<<13)      // Analog input sets the velocity (needs the analog input enabled, cleared by a stop or the stop switch)
+#define REG_CONTROL_B_ENABLE_ANALOG_POSITION           (1<<14)      // Analog input sets the position (needs the analog input enabled, cleared by a stop or the stop switch)
+#define REG_CONTROL_B_DISABLE_ANALOG_FOLLOW            (1U<<15)     // Analog input doesn't control the motor
 
 #define REG_HOME_STEPS_EVENTS_B_HOMING_SUCCESSFUL      (1<<0)       // Homing terminated successfully
 #define REG_HOME_STEPS_EVENTS_B_HOMING_FAILED          (1<<1)       // Homing failed, motor moved but home position was not reached
 #define REG_HOME_STEPS_EVENTS_B_ALREADY_HOME           (1<<2)       // Tried homing while already at home position
 #define REG_HOME_STEPS_EVENTS_B_UNEXPECTED_HOME        (1<<3)       // Home sensor triggered unexpectedly
+#define REG_HOME_STEPS_EVENTS_B_TIMEOUT                (1<<4)       // A phase of the homing took longer than its timeout
+
+
+#define REG_MOVE_TO_EVENTS_B_TARGET_REACHED            (1<<0)       // The movement ended at the target position
+#define REG_MOVE_TO_EVENTS_B_STOP_SWITCH               (1<<1)       // The movement was interrupted by the stop switch
+#define REG_MOVE_TO_EVENTS_B_RETARGETED                (1<<2)       // A new target or velocity was given before reaching the target
+#define REG_MOVE_TO_EVENTS_B_STOPPED                   (1<<3)       // The movement was stopped by a command
+
+
+#define REG_POSITION_LIMIT_EVENTS_B_MINIMUM            (1<<0)       // The minimum position limit was reached
+#define REG_POSITION_LIMIT_EVENTS_B_MAXIMUM            (1<<1)       // The maximum position limit was reached
+#define REG_POSITION_LIMIT_EVENTS_B_TARGET_CLAMPED     (1<<2)       // A target beyond the limit was replaced by the limit
 
 
 #define REG_STOP_SWITCH_B_STOP_SWITCH                 (1<<0)		// 
@@ -166,4 +365,69 @@ typedef struct
 #define REG_HOME_SWITCH_B_HOME_SWITCH                  (1<<0)       //
 #define B_MOTOR_BRAKE                      (1<<0)					//
 
+#define REG_FRAME_POSITION                             0            // Index of motor_current_position on REG_FRAME
+#define REG_FRAME_ENCODER                              1            // Index of the quadrature encoder reading on REG_FRAME
+#define REG_FRAME_ANALOG_INPUT                         2            // Index of the analog input reading on REG_FRAME
+#define REG_FRAME_VELOCITY                             3            // Index of the signed commanded velocity on REG_FRAME
+#define REG_FRAME_STATUS                               4            // Index of the status flags on REG_FRAME
+
+#define REG_FRAME_STATUS_B_MOVING                      (1<<0)       // Motor is running
+#define REG_FRAME_STATUS_B_STOP_SWITCH                 (1<<1)       // Stop switch is active
+#define REG_FRAME_STATUS_B_HOME_SWITCH                 (1<<2)       // Home switch is active
+#define REG_FRAME_STATUS_B_MOTOR_ENABLED               (1<<3)       // Motor driver is enabled
+#define REG_FRAME_STATUS_B_HOMING                      (1<<4)       // A homing movement is in progress
+
+#define REG_TRACE_CONTROL_B_ARM                        (1<<0)       // Start capturing with the next movement and stop when the motor stops
+#define REG_TRACE_CONTROL_B_START                      (1<<1)       // Start capturing immediately
+#define REG_TRACE_CONTROL_B_STOP                       (1<<2)       // Stop capturing
+#define REG_TRACE_CONTROL_B_ARMED                      (1<<4)       // Capture is waiting for the next movement (read only)
+#define REG_TRACE_CONTROL_B_RUNNING                    (1<<5)       // Capture is running (read only)
+#define REG_TRACE_CONTROL_B_DONE                       (1<<6)       // Capture finished and data can be read (read only)
+#define REG_TRACE_CONTROL_B_OVERFLOW                   (1<<7)       // Oldest samples were overwritten (read only)
+
+#define REG_TRACE_SIGNALS_B_STEP_TIME                  (1<<0)       // Time of the step since the capture started (us, lower 16 bits)
+#define REG_TRACE_SIGNALS_B_STEP_PERIOD                (1<<1)       // Commanded step period (us)
+#define REG_TRACE_SIGNALS_B_ENCODER                    (1<<2)       // Quadrature encoder reading
+#define REG_TRACE_SIGNALS_B_ANALOG                     (1<<3)       // Last analog input reading
+
+#define REG_DIGITAL_INPUTS_B_INPUT_0                   (1<<0)       // State of INPUT_0
+#define REG_DIGITAL_INPUTS_B_INPUT_1                   (1<<1)       // State of INPUT_1
+
+#define REG_TRIGGER_CONFIG_B_INPUT_0_RISING            (1<<0)       // Rising edge of INPUT_0 starts the movement
+#define REG_TRIGGER_CONFIG_B_INPUT_0_FALLING           (1<<1)       // Falling edge of INPUT_0 starts the movement
+#define REG_TRIGGER_CONFIG_B_INPUT_1_RISING            (1<<2)       // Rising edge of INPUT_1 starts the movement
+#define REG_TRIGGER_CONFIG_B_INPUT_1_FALLING           (1<<3)       // Falling edge of INPUT_1 starts the movement
+#define REG_TRIGGER_CONFIG_B_RELATIVE                  (1<<7)       // REG_TRIGGER_MOVE_TO is relative to the position at the trigger
+
+#define REG_PVT_CONTROL_B_START                        (1<<0)       // Start following the setpoints from the current position
+#define REG_PVT_CONTROL_B_STOP                         (1<<1)       // Decelerate to a stop and clear the FIFO
+#define REG_PVT_CONTROL_B_CLEAR                        (1<<2)       // Clear the FIFO without stopping
+#define REG_PVT_CONTROL_B_RUNNING                      (1<<4)       // Streaming is running (read only)
+#define REG_PVT_CONTROL_B_UNDERRUN                     (1<<5)       // FIFO ran empty while moving (read only)
+
+#define REG_GEARING_CONTROL_B_START                    (1<<0)       // Start following the encoder from the current position
+#define REG_GEARING_CONTROL_B_STOP                     (1<<1)       // Stop following the encoder and decelerate to a stop
+#define REG_GEARING_CONTROL_B_RUNNING                  (1<<4)       // The motor is following the encoder (read only)
+
+#define REG_SUPERVISOR_CONTROL_B_ENABLE                (1<<0)       // Compare the motor position with the encoder
+#define REG_SUPERVISOR_CONTROL_B_CORRECT               (1<<1)       // Take the missed steps at the end of each movement to a target
+#define REG_SUPERVISOR_CONTROL_B_STALLED               (1<<4)       // The following error is over the threshold (read only)
+
+#define REG_AUTOTUNE_CONTROL_B_START                   (1<<0)       // Start the trial movements from the current position
+#define REG_AUTOTUNE_CONTROL_B_ABORT                   (1<<1)       // Stop the trial movements and restore the motion parameters
+#define REG_AUTOTUNE_CONTROL_B_RUNNING                 (1<<4)       // The trial movements are running (read only)
+#define REG_AUTOTUNE_CONTROL_B_DONE                    (1<<5)       // The last auto-tune ended with results (read only)
+#define REG_AUTOTUNE_CONTROL_B_FAILED                  (1<<6)       // The last auto-tune didn't find safe parameters (read only)
+
+#define REG_COMPARE_CONTROL_B_OUTPUT_0                 (1<<0)       // Pulse OUTPUT_0 at its trigger positions
+#define REG_COMPARE_CONTROL_B_OUTPUT_1                 (1<<1)       // Pulse OUTPUT_1 at its trigger positions
+#define REG_COMPARE_CONTROL_B_TABLE_0                  (1<<2)       // OUTPUT_0 uses the positions on REG_COMPARE_TABLE
+#define REG_COMPARE_CONTROL_B_TABLE_1                  (1<<3)       // OUTPUT_1 uses the positions on REG_COMPARE_TABLE
+
+#define REG_SEQUENCE_CONTROL_B_START                   (1<<0)       // Start the motion sequence from the first instruction
+#define REG_SEQUENCE_CONTROL_B_ABORT                   (1<<1)       // Stop the motion sequence and the movement it started
+#define REG_SEQUENCE_CONTROL_B_RUNNING                 (1<<4)       // The motion sequence is running (read only)
+#define REG_SEQUENCE_CONTROL_B_DONE                    (1<<5)       // The last motion sequence reached its end (read only)
+#define REG_SEQUENCE_CONTROL_B_FAILED                  (1<<6)       // The last motion sequence was stopped before its end, failed an instruction or lost the motor to a host command (read only)
+
 #endif /* _APP_REGS_H_ */
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "binary_link.h"
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Bytes of the frame being received (without the sync byte)
+uint8_t binary_link_buffer[BINARY_LINK_FRAME_SIZE - 1];
+
+// Number of bytes received after the sync byte, 0 while waiting for the sync byte
+uint8_t binary_link_index = 0;
+
+// Milliseconds since the last byte of a partial frame was received
+uint8_t binary_link_idle_time = 0;
+
+// Number of frames dropped because of a wrong CRC
+uint16_t binary_link_crc_errors = 0;
+
+// Number of frames dropped because of a framing error, a receive buffer overflow or a full command queue
+uint16_t binary_link_line_errors = 0;
+
+// Commands received but not executed yet
+BinaryLinkCommand binary_link_queue[BINARY_LINK_QUEUE_SIZE];
+volatile uint8_t binary_link_queue_head = 0;
+volatile uint8_t binary_link_queue_tail = 0;
+
+// A partial frame is dropped after this time without receiving bytes (ms)
+#define BINARY_LINK_TIMEOUT 2
+
+
+/************************************************************************/
+/* Parser                                                               */
+/************************************************************************/
+
+uint8_t binary_link_crc8(uint8_t crc, uint8_t byte)
+{
+	crc ^= byte;
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+	}
+	return crc;
+}
+
+void binary_link_reset(void)
+{
+	binary_link_index = 0;
+}
+
+void binary_link_drop_frame(void)
+{
+	// Only counted if there was a frame to drop, a byte lost between frames doesn't break anything yet
+	if (binary_link_index != 0) binary_link_line_errors++;
+	binary_link_reset();
+}
+
+void binary_link_check_timeout(void)
+{
+	if (binary_link_index == 0) return;
+	
+	if (++binary_link_idle_time >= BINARY_LINK_TIMEOUT)
+	{
+		binary_link_reset();
+	}
+}
+
+bool binary_link_parse_byte(uint8_t byte, BinaryLinkCommand *command)
+{
+	binary_link_idle_time = 0;
+	
+	// Wait for the start of a frame
+	if (binary_link_index == 0)
+	{
+		if (byte == BINARY_LINK_SYNC) binary_link_index = 1;
+		return false;
+	}
+	
+	binary_link_buffer[binary_link_index - 1] = byte;
+	
+	if (++binary_link_index < BINARY_LINK_FRAME_SIZE) return false;
+	
+	binary_link_index = 0;
+	
+	uint8_t crc = 0;
+	for (uint8_t i = 0; i < BINARY_LINK_FRAME_SIZE - 2; i++)
+	{
+		crc = binary_link_crc8(crc, binary_link_buffer[i]);
+	}
+	
+	if (crc != binary_link_buffer[BINARY_LINK_FRAME_SIZE - 2])
+	{
+		binary_link_crc_errors++;
+		return false;
+	}
+	
+	command->command = binary_link_buffer[0];
+	command->argument = (int32_t)((uint32_t)binary_link_buffer[1] | ((uint32_t)binary_link_buffer[2] << 8) | ((uint32_t)binary_link_buffer[3] << 16) | ((uint32_t)binary_link_buffer[4] << 24));
+	return true;
+}
+
+
+/************************************************************************/
+/* Command queue                                                        */
+/************************************************************************/
+
+bool binary_link_queue_push(BinaryLinkCommand *command)
+{
+	uint8_t next = (binary_link_queue_tail + 1) % BINARY_LINK_QUEUE_SIZE;
+	
+	// One slot is kept free to tell a full queue from an empty one
+	if (next == binary_link_queue_head)
+	{
+		binary_link_line_errors++;
+		return false;
+	}
+	
+	binary_link_queue[binary_link_queue_tail] = *command;
+	binary_link_queue_tail = next;
+	return true;
+}
+
+bool binary_link_queue_pop(BinaryLinkCommand *command)
+{
+	if (binary_link_queue_head == binary_link_queue_tail) return false;
+	
+	*command = binary_link_queue[binary_link_queue_head];
+	binary_link_queue_head = (binary_link_queue_head + 1) % BINARY_LINK_QUEUE_SIZE;
+	return true;
+}
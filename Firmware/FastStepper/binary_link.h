@@ -0,0 +1,66 @@
+#ifndef _BINARY_LINK_H_
+#define _BINARY_LINK_H_
+#include <stdint.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+/************************************************************************/
+/* Frame format (7 bytes)                                               */
+/*                                                                      */
+/* [SYNC] [COMMAND] [ARGUMENT (I32, little endian)] [CRC-8]             */
+/*                                                                      */
+/* The CRC-8 (polynomial 0x07, initial value 0x00) covers the command   */
+/* and the argument bytes.                                              */
+/************************************************************************/
+#define BINARY_LINK_SYNC            0xA5
+#define BINARY_LINK_FRAME_SIZE      7
+
+#define BINARY_LINK_CMD_MOVE_TO     0x01    // Argument: target position (steps)
+#define BINARY_LINK_CMD_VELOCITY    0x02    // Argument: same as REG_DIRECT_VELOCITY
+#define BINARY_LINK_CMD_STOP        0x03    // Argument: ignored
+#define BINARY_LINK_CMD_PRESET      0x04    // Argument: preset to start (0 is the REG_TRIGGER_MOVE_TO movement, 1 to 4 are REG_PRESET_MOVE_TO)
+
+// The presets are started by the receive interrupt, the other commands are queued and executed on the main loop (within 500 us)
+
+// A received frame with a valid CRC
+typedef struct
+{
+	uint8_t command;
+	int32_t argument;
+} BinaryLinkCommand;
+
+// Update a CRC-8 with one byte
+uint8_t binary_link_crc8(uint8_t crc, uint8_t byte);
+
+// Feed one received byte to the parser, returns true when command holds a complete and valid frame
+// This function doesn't touch the hardware, so it can run on the host
+bool binary_link_parse_byte(uint8_t byte, BinaryLinkCommand *command);
+
+// Drop a partially received frame
+void binary_link_reset(void);
+
+// Drop the frame being received because a byte was corrupted or lost on the line
+void binary_link_drop_frame(void);
+
+// Drop a partially received frame if no byte arrived for a while (called every ms)
+void binary_link_check_timeout(void);
+
+// Number of received commands waiting for the main loop
+#define BINARY_LINK_QUEUE_SIZE 4
+
+// Queue a received command for the main loop (called from the receive interrupt)
+// Returns false and drops the command if the queue is full
+bool binary_link_queue_push(BinaryLinkCommand *command);
+
+// Take the oldest queued command (called from the main loop), returns false if there is none
+// The interrupt only writes the tail and the main loop only writes the head, so no critical section is needed
+bool binary_link_queue_pop(BinaryLinkCommand *command);
+
+#endif /* _BINARY_LINK_H_ */
@@ -0,0 +1,98 @@
+#include "eeprom_config.h"
+#include "cpu.h"
+#include "analog_input.h"
+#include "stepper_motor.h"
+#include "move_triggers.h"
+#include "binary_link.h"
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Configuration as it is saved on the EEPROM
+typedef struct
+{
+	uint16_t signature;
+	int16_t adc_offset;
+	MotionProfile motion_profile;
+	int32_t preset_targets[MOVE_PRESETS_COUNT];
+	uint8_t presets_relative;
+	uint8_t trigger_preset;
+	uint8_t crc;
+} EepromConfig;
+
+// Copy of the configuration being saved, taken at the start of each pass over the EEPROM
+EepromConfig eeprom_config;
+
+// Byte of the configuration compared on the next update
+uint8_t eeprom_config_index = 0;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern int16_t AdcOffset;
+extern bool autotune_is_running;
+extern int32_t move_preset_targets[];
+extern uint8_t move_presets_relative;
+extern uint8_t trigger_preset;
+
+// CRC-8 of everything but the CRC itself
+static uint8_t eeprom_config_crc(EepromConfig *config)
+{
+	uint8_t crc = 0;
+	
+	for (uint8_t i = 0; i < sizeof(EepromConfig) - 1; i++)
+		crc = binary_link_crc8(crc, ((uint8_t*)config)[i]);
+	
+	return crc;
+}
+
+bool eeprom_config_load(void)
+{
+	EepromConfig config;
+	
+	for (uint8_t i = 0; i < sizeof(EepromConfig); i++)
+		((uint8_t*)&config)[i] = eeprom_rd_byte(EEPROM_CONFIG_ADDRESS + i);
+	
+	// A blank EEPROM or a save interrupted by a reset keeps the defaults
+	if (config.signature != EEPROM_CONFIG_SIGNATURE || config.crc != eeprom_config_crc(&config)) return false;
+	
+	set_adc_offset(config.adc_offset);
+	set_motion_profile(&config.motion_profile);
+	
+	// Planned after the motion profile, so they start with it
+	for (uint8_t i = 0; i < MOVE_PRESETS_COUNT; i++)
+		prepare_move_preset(i + 1, config.preset_targets[i], (config.presets_relative & (1 << i)) ? true : false);
+	set_trigger_preset(config.trigger_preset);
+	
+	return true;
+}
+
+void eeprom_config_update(void)
+{
+	// The auto-tune trials change the motion profile many times before restoring it
+	if (autotune_is_running || !adc_offset_is_valid() || eeprom_is_busy()) return;
+	
+	if (eeprom_config_index == 0)
+	{
+		eeprom_config.signature = EEPROM_CONFIG_SIGNATURE;
+		eeprom_config.adc_offset = AdcOffset;
+		get_motion_profile(&eeprom_config.motion_profile);
+		for (uint8_t i = 0; i < MOVE_PRESETS_COUNT; i++)
+			eeprom_config.preset_targets[i] = move_preset_targets[i];
+		eeprom_config.presets_relative = move_presets_relative;
+		eeprom_config.trigger_preset = trigger_preset;
+		eeprom_config.crc = eeprom_config_crc(&eeprom_config);
+	}
+	
+	// Only the bytes that changed are written, which also spares the EEPROM
+	uint8_t byte = ((uint8_t*)&eeprom_config)[eeprom_config_index];
+	if (eeprom_rd_byte(EEPROM_CONFIG_ADDRESS + eeprom_config_index) != byte)
+	{
+		eeprom_wr_byte(EEPROM_CONFIG_ADDRESS + eeprom_config_index, byte);
+	}
+	
+	if (++eeprom_config_index >= sizeof(EepromConfig)) eeprom_config_index = 0;
+}
@@ -0,0 +1,26 @@
+#ifndef _EEPROM_CONFIG_H_
+#define _EEPROM_CONFIG_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Kept on the last 64 bytes of the 1 KB EEPROM, away from the register bank saved by the core
+#define EEPROM_CONFIG_ADDRESS 0x3C0
+
+// Changes when the layout of the saved configuration changes
+#define EEPROM_CONFIG_SIGNATURE 0x4602
+
+// Apply the ADC offset, the motion profile and the move presets saved on the EEPROM, returns false if there is none
+bool eeprom_config_load(void);
+
+// Save one byte of the configuration that changed, so the EEPROM writes never block (called every ms)
+void eeprom_config_update(void);
+
+#endif /* _EEPROM_CONFIG_H_ */
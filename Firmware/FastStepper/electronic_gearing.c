@@ -0,0 +1,142 @@
+#include "electronic_gearing.h"
+#include "cpu.h"
+#include "app_ios_and_regs.h"
+#include "stepper_motor.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Flag indicating the motor is following the encoder
+bool gearing_is_running = false;
+
+// Motor steps per encoder count, as a fraction
+int16_t gearing_numerator = 1;
+int16_t gearing_denominator = 1;
+
+// Time between gearing updates (s)
+#define GEARING_UPDATE_PERIOD (GEARING_UPDATE_PERIOD_US * 0.000001)
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// TCD1 count seen on the last update
+uint16_t gearing_previous_count;
+
+// Part of the scaled encoder counts that didn't make a full step yet (in 1/denominator steps)
+int32_t gearing_remainder;
+
+// Position the motor should be at, following the encoder (steps)
+int32_t gearing_target_position;
+
+// Filtered velocity of the target position, used as feed forward (steps/s)
+float gearing_feed_forward = 0;
+
+// Velocity commanded on the last update (steps/s)
+float gearing_commanded_velocity = 0;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern float motor_acceleration;
+extern float motor_deceleration;
+extern bool motor_is_running;
+extern bool jog_is_active;
+extern bool pvt_is_running;
+extern uint8_t position_limit_events;
+extern AppRegs app_regs;
+
+bool gearing_set_ratio(int16_t numerator, int16_t denominator)
+{
+	if (denominator <= 0) return false;
+	
+	// The update interrupt uses the ratio, so both parts must change together
+	/* Disable low level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	gearing_numerator = numerator;
+	gearing_denominator = denominator;
+	gearing_remainder = 0;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+bool gearing_start(void)
+{
+	// Gearing takes over the motor, so it can't start on top of another movement
+	if (gearing_is_running || motor_is_running || jog_is_active || pvt_is_running) return false;
+	
+	gearing_previous_count = TCD1_CNT;
+	gearing_remainder = 0;
+	gearing_target_position = get_motor_position();
+	gearing_feed_forward = 0;
+	gearing_commanded_velocity = 0;
+	position_limit_events = 0;
+	gearing_is_running = true;
+	
+	// 2 us per timer count
+	timer_type0_enable(&TCE0, TIMER_PRESCALER_DIV64, (GEARING_UPDATE_PERIOD_US >> 1) - 1, INT_LEVEL_LOW);
+	
+	return true;
+}
+
+void gearing_stop(void)
+{
+	timer_type0_stop(&TCE0);
+	
+	if (gearing_is_running)
+	{
+		gearing_is_running = false;
+		quick_stop_motor();
+	}
+}
+
+// Limit the change of the commanded velocity to the configured acceleration and deceleration
+static float gearing_limit_velocity(float velocity)
+{
+	float magnitude = (gearing_commanded_velocity >= 0) ? gearing_commanded_velocity : -gearing_commanded_velocity;
+	float target_magnitude = (velocity >= 0) ? velocity : -velocity;
+	bool speeding_up = (target_magnitude > magnitude) && ((velocity >= 0) == (gearing_commanded_velocity >= 0));
+	
+	float max_change = ((speeding_up) ? motor_acceleration : -motor_deceleration) * GEARING_UPDATE_PERIOD;
+	
+	if (velocity > gearing_commanded_velocity + max_change) return gearing_commanded_velocity + max_change;
+	if (velocity < gearing_commanded_velocity - max_change) return gearing_commanded_velocity - max_change;
+	return velocity;
+}
+
+ISR(TCE0_OVF_vect/*, ISR_NAKED*/)
+{
+	// Leave the gearing mode if the motor was disabled, the stop switch was hit or a position limit was reached
+	if (!read_STOP_SWITCH || !(app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_MOTOR) || position_limit_events)
+	{
+		timer_type0_stop(&TCE0);
+		gearing_is_running = false;
+		return;
+	}
+	
+	// The encoder counts down on TCD1, so the difference is taken backwards
+	uint16_t count = TCD1_CNT;
+	int16_t delta = (int16_t)(gearing_previous_count - count);
+	gearing_previous_count = count;
+	
+	// Scale by the ratio keeping the remainder, so no fraction of a step is ever lost
+	int32_t scaled = (int32_t)delta * gearing_numerator + gearing_remainder;
+	int32_t steps = scaled / gearing_denominator;
+	gearing_remainder = scaled - steps * gearing_denominator;
+	gearing_target_position += steps;
+	
+	// Smooth the coarse per-update step count before using it as feed forward
+	gearing_feed_forward += ((float)steps / GEARING_UPDATE_PERIOD - gearing_feed_forward) * 0.125;
+	
+	// Correct the velocity with the following error, so the motor doesn't drift from the encoder
+	float following_error = (float)(gearing_target_position - get_motor_position());
+	gearing_commanded_velocity = gearing_limit_velocity(gearing_feed_forward + GEARING_POSITION_GAIN * following_error);
+	
+	run_motor_at_velocity(gearing_commanded_velocity);
+}
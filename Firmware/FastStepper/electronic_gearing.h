@@ -0,0 +1,29 @@
+#ifndef _ELECTRONIC_GEARING_H_
+#define _ELECTRONIC_GEARING_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Period of the gearing update, running on TCE0 (us)
+#define GEARING_UPDATE_PERIOD_US 250
+
+// Gain applied to the following error to correct the commanded velocity (1/s)
+#define GEARING_POSITION_GAIN 50.0
+
+// Set the number of motor steps per encoder count as numerator/denominator
+bool gearing_set_ratio(int16_t numerator, int16_t denominator);
+
+// Start following the encoder from the current motor position
+bool gearing_start(void);
+
+// Stop following the encoder and decelerate the motor to a stop
+void gearing_stop(void);
+
+#endif /* _ELECTRONIC_GEARING_H_ */
@@ -0,0 +1,88 @@
+#include "emergency_stop.h"
+#include "cpu.h"
+#include "app_ios_and_regs.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Time from the last stop switch activation until its interrupt stopped the motor (us)
+uint16_t emergency_stop_latency = 0;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// TCC1 count at the stop switch edge, copied by the DMA so no timer channel is needed
+// TCC1 is the timestamp timer of the core (R_TIMESTAMP_MICRO), it counts 32 us per tick and wraps every second
+volatile uint16_t emergency_stop_edge_count = 0;
+
+#define EMERGENCY_STOP_TICK_US 32
+#define EMERGENCY_STOP_TIMER_PERIOD 31250
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+void init_emergency_stop(void)
+{
+	/* Stop switch (PB0, falling edge) on event channel 1 */
+	EVSYS_CH1MUX = EVSYS_CHMUX_PORTB_PIN0_gc;
+	EVSYS_CH1CTRL = EVSYS_DIGFILT_1SAMPLE_gc;
+	
+	/* The fault clears the direction of the pins of the DTI channel A, leaving MOTOR_PULSE (PC0) as an input */
+	/* Dead time is 0 and the output override is off, so the timer drives the pin as before while there is no fault */
+	AWEXC_CTRL = AWEX_DTICCAEN_bm;
+	AWEXC_DTBOTH = 0;
+	AWEXC_OUTOVEN = 0;
+	AWEXC_FDEMASK = (1 << 1);
+	AWEXC_FDCTRL = AWEX_FDACT_CLEARDIR_gc;
+	
+	/* Keep MOTOR_PULSE at its idle level (low, see stop_motor()) while it's an input */
+	/* A fault during the low phase of a step then leaves the pin low instead of making a rising edge */
+	PORTC_PIN0CTRL = (PORTC_PIN0CTRL & ~PORT_OPC_gm) | PORT_OPC_PULLDOWN_gc;
+	
+	/* The same event makes the DMA channel 0 copy TCC1_CNT (2 bytes) to emergency_stop_edge_count */
+	/* Repeated forever, so every activation of the switch is timestamped */
+	DMA_CTRL = DMA_ENABLE_bm;
+	DMA_CH0_ADDRCTRL = DMA_CH_SRCRELOAD_BURST_gc | DMA_CH_SRCDIR_INC_gc | DMA_CH_DESTRELOAD_BURST_gc | DMA_CH_DESTDIR_INC_gc;
+	DMA_CH0_TRIGSRC = DMA_CH_TRIGSRC_EVSYS_CH1_gc;
+	DMA_CH0_TRFCNT = 2;
+	DMA_CH0_REPCNT = 0;
+	DMA_CH0_SRCADDR0 = (uint8_t)((uintptr_t)&TCC1_CNT);
+	DMA_CH0_SRCADDR1 = (uint8_t)((uintptr_t)&TCC1_CNT >> 8);
+	DMA_CH0_SRCADDR2 = 0;
+	DMA_CH0_DESTADDR0 = (uint8_t)((uintptr_t)&emergency_stop_edge_count);
+	DMA_CH0_DESTADDR1 = (uint8_t)((uintptr_t)&emergency_stop_edge_count >> 8);
+	DMA_CH0_DESTADDR2 = 0;
+	DMA_CH0_CTRLA = DMA_CH_ENABLE_bm | DMA_CH_REPEAT_bm | DMA_CH_BURSTLEN_2BYTE_gc;
+}
+
+bool emergency_stop_is_active(void)
+{
+	return (AWEXC_STATUS & AWEX_FDF_bm) ? true : false;
+}
+
+void emergency_stop_record_latency(void)
+{
+	// The DMA copied the count long before the interrupt could run, so the difference is the latency
+	uint16_t now = TCC1_CNT;
+	uint16_t edge = emergency_stop_edge_count;
+	uint16_t ticks = (now >= edge) ? now - edge : now + EMERGENCY_STOP_TIMER_PERIOD - edge;
+	
+	uint32_t latency = (uint32_t)ticks * EMERGENCY_STOP_TICK_US;
+	emergency_stop_latency = (latency > 65535) ? 65535 : (uint16_t)latency;
+}
+
+bool emergency_stop_release(void)
+{
+	// The fault is latched until the switch is released and the flag is cleared
+	if (!emergency_stop_is_active() || !read_STOP_SWITCH) return false;
+	
+	AWEXC_STATUS = AWEX_FDF_bm;
+	PORTC_DIRSET = (1 << 0);
+	
+	return true;
+}
@@ -0,0 +1,27 @@
+#ifndef _EMERGENCY_STOP_H_
+#define _EMERGENCY_STOP_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Route the stop switch through the event system to the TCC0 fault input, so the step pulses are cut in hardware
+// The same event timestamps the edge with the DMA, so REG_STOP_LATENCY measures when the firmware reacted
+void init_emergency_stop(void);
+
+// Returns true while the step pulses are cut by the stop switch
+bool emergency_stop_is_active(void);
+
+// Measure the time since the stop switch edge, timestamped by the DMA (called first thing on the stop switch interrupt)
+void emergency_stop_record_latency(void);
+
+// Give the step output back to the timer once the stop switch is released, returns true when it was restored
+bool emergency_stop_release(void);
+
+#endif /* _EMERGENCY_STOP_H_ */
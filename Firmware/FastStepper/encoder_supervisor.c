@@ -0,0 +1,139 @@
+#include "encoder_supervisor.h"
+#include "stepper_motor.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Flag indicating the motor position is being compared with the encoder
+bool supervisor_is_enabled = false;
+
+// Flag indicating the missed steps are taken at the end of each movement
+bool supervisor_corrects = false;
+
+// Flag indicating the following error went over the threshold
+bool supervisor_stalled = false;
+
+// Motor steps per encoder count
+float supervisor_steps_per_count = 1.0;
+
+// Following error that means the motor stalled (steps)
+int32_t supervisor_threshold = 100;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// TCD1 count seen on the last update
+uint16_t supervisor_previous_count;
+
+// Encoder position since the last reset, extended to 32 bits (counts)
+int32_t supervisor_encoder_position;
+
+// Motor position when the supervisor was reset (steps)
+int32_t supervisor_motor_reference;
+
+// Last following error (steps)
+int32_t supervisor_following_error = 0;
+
+// Flag indicating the current movement is the correction of the previous one, so it isn't corrected again
+bool supervisor_correcting = false;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern int32_t motor_target_position;
+extern bool motor_has_target;
+extern enum MovementStatus current_movement_status;
+
+bool supervisor_set_config(int32_t numerator, int32_t denominator, int32_t threshold)
+{
+	if (numerator == 0 || denominator <= 0 || threshold <= 0) return false;
+	
+	supervisor_steps_per_count = (float)numerator / denominator;
+	supervisor_threshold = threshold;
+	supervisor_reset();
+	
+	return true;
+}
+
+void supervisor_enable(bool enable, bool correct)
+{
+	if (enable && !supervisor_is_enabled) supervisor_reset();
+	
+	supervisor_is_enabled = enable;
+	supervisor_corrects = correct;
+}
+
+void supervisor_reset(void)
+{
+	supervisor_previous_count = TCD1_CNT;
+	supervisor_encoder_position = 0;
+	supervisor_motor_reference = get_motor_position();
+	supervisor_following_error = 0;
+	supervisor_stalled = false;
+}
+
+int32_t supervisor_get_following_error(void)
+{
+	return supervisor_following_error;
+}
+
+bool supervisor_update(void)
+{
+	if (supervisor_is_enabled == false) return false;
+	
+	// The encoder counts down on TCD1, so the difference is taken backwards
+	uint16_t count = TCD1_CNT;
+	supervisor_encoder_position += (int16_t)(supervisor_previous_count - count);
+	supervisor_previous_count = count;
+	
+	float encoder_steps = supervisor_encoder_position * supervisor_steps_per_count;
+	supervisor_following_error = (get_motor_position() - supervisor_motor_reference) - (int32_t)encoder_steps;
+	
+	int32_t error = (supervisor_following_error >= 0) ? supervisor_following_error : -supervisor_following_error;
+	
+	// Report the stall once, until the error goes back to well below the threshold
+	if (supervisor_stalled)
+	{
+		if (error < supervisor_threshold/2) supervisor_stalled = false;
+		return false;
+	}
+	
+	if (error > supervisor_threshold)
+	{
+		supervisor_stalled = true;
+		return true;
+	}
+	
+	return false;
+}
+
+void supervisor_on_motor_stopped(void)
+{
+	bool was_correcting = supervisor_correcting;
+	supervisor_correcting = false;
+	
+	if (supervisor_is_enabled == false || supervisor_corrects == false || was_correcting) return;
+	
+	// Only movements that reached their target are corrected, and a stall needs the user's attention instead
+	if (supervisor_stalled || motor_has_target == false || current_movement_status == MOVEMENT_STATUS_HOMING) return;
+	
+	int32_t position = get_motor_position();
+	if (position != motor_target_position) return;
+	
+	// The encoder resolution doesn't allow telling apart errors smaller than a count
+	float resolution = (supervisor_steps_per_count >= 0) ? supervisor_steps_per_count : -supervisor_steps_per_count;
+	int32_t error = (supervisor_following_error >= 0) ? supervisor_following_error : -supervisor_following_error;
+	if (error <= resolution) return;
+	
+	// Redefine the position as measured by the encoder and move again to the same target to take the missed steps
+	int32_t target = motor_target_position;
+	set_motor_position(position - supervisor_following_error);
+	supervisor_reset();
+	supervisor_correcting = true;
+	move_to_target_position(target);
+}
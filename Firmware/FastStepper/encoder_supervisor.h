@@ -0,0 +1,32 @@
+#ifndef _ENCODER_SUPERVISOR_H_
+#define _ENCODER_SUPERVISOR_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Set the motor steps per encoder count (numerator/denominator) and the following error that means a stall (steps)
+bool supervisor_set_config(int32_t numerator, int32_t denominator, int32_t threshold);
+
+// Enable or disable the supervisor, and the correction of the missed steps at the end of each movement
+void supervisor_enable(bool enable, bool correct);
+
+// Take the current motor and encoder positions as matching, called whenever one of them is redefined
+void supervisor_reset(void);
+
+// Compare the motor position with the encoder, returns true when a stall is detected (called every 500 us)
+bool supervisor_update(void);
+
+// Take the missed steps found by the encoder, called when the motor stops
+void supervisor_on_motor_stopped(void);
+
+// Difference between the motor position and the position measured by the encoder (steps)
+int32_t supervisor_get_following_error(void);
+
+#endif /* _ENCODER_SUPERVISOR_H_ */
@@ -0,0 +1,252 @@
+#include "homing.h"
+#include "cpu.h"
+#include "app_ios_and_regs.h"
+#include "stepper_motor.h"
+#include "move_triggers.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Velocity of the fast approach to the switch (steps/s)
+uint16_t homing_velocity = 0;
+
+// Distance moved away from the switch before the slow approach (steps)
+int32_t homing_back_off_distance = 200;
+
+// Maximum duration of each phase (ms)
+uint32_t homing_seek_timeout = 0;
+uint32_t homing_back_off_timeout = 0;
+uint32_t homing_latch_timeout = 0;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+volatile enum HomingPhase homing_phase = HOMING_IDLE;
+
+// Phase seen on the last update, to report the changes
+enum HomingPhase homing_reported_phase = HOMING_IDLE;
+
+// Time spent on the current phase (ms)
+uint32_t homing_phase_time;
+
+// Direction of the switch
+bool homing_direction_is_positive;
+
+// Position where the fast approach started and the maximum distance it can move from there
+int32_t homing_seek_origin;
+int32_t homing_seek_distance;
+
+// Flag indicating the switch was found during the fast approach
+bool homing_switch_found;
+
+// State of the home switch seen by its interrupt, to ignore repeated edges
+bool home_switch_is_active = false;
+
+// Motor position (steps) and timestamp (seconds, microseconds) of the last home switch activation
+int32_t home_switch_latch[3];
+
+// REG_HOME_STEPS_EVENTS bits to report for the last activation (0 during the fast approach, which doesn't set the origin)
+uint8_t home_switch_events;
+
+// Send the home switch events from the main loop, the first one reports the state at startup
+bool send_home_switch_notification = true;
+bool send_home_switch_latch_notification = false;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern bool motor_is_running;
+extern bool jog_is_active;
+extern int32_t motor_current_position;
+extern enum MovementStatus current_movement_status;
+extern uint16_t motor_minimum_velocity;
+extern uint8_t home_steps_events;
+
+bool homing_set_velocity(uint32_t velocity)
+{
+	if (velocity > 65535) return false;
+	
+	homing_velocity = velocity;
+	return true;
+}
+
+bool homing_set_config(int32_t back_off_distance, int32_t seek_timeout, int32_t back_off_timeout, int32_t latch_timeout)
+{
+	if (back_off_distance <= 0 || seek_timeout < 0 || back_off_timeout < 0 || latch_timeout < 0) return false;
+	
+	homing_back_off_distance = back_off_distance;
+	homing_seek_timeout = seek_timeout;
+	homing_back_off_timeout = back_off_timeout;
+	homing_latch_timeout = latch_timeout;
+	
+	return true;
+}
+
+static void homing_set_phase(enum HomingPhase phase)
+{
+	homing_phase = phase;
+	homing_phase_time = 0;
+}
+
+// Move away from the switch, so it can be approached again slowly
+static void homing_start_back_off(void)
+{
+	int32_t distance = (homing_direction_is_positive) ? -homing_back_off_distance : homing_back_off_distance;
+	
+	homing_set_phase(HOMING_BACK_OFF);
+	move_to_target_position(get_motor_position() + distance);
+}
+
+// Approach the switch at the minimum velocity, the position is set to 0 once it activates
+static void homing_start_latch(int32_t homing_distance)
+{
+	homing_set_phase(HOMING_LATCH);
+	move_to_home(homing_distance);
+}
+
+// End the routine without reaching the switch
+static void homing_fail(uint8_t events)
+{
+	if (motor_is_running) quick_stop_motor();
+	homing_set_phase(HOMING_IDLE);
+	home_steps_events = REG_HOME_STEPS_EVENTS_B_HOMING_FAILED | events;
+}
+
+void homing_start(int32_t homing_distance)
+{
+	homing_direction_is_positive = (homing_distance > 0);
+	
+	// Without a faster velocity, the whole distance is done on the slow approach
+	if (homing_velocity <= motor_minimum_velocity)
+	{
+		homing_start_latch(homing_distance);
+		return;
+	}
+	
+	// The switch may already be active, which leaves only the back off and the slow approach
+	if (!read_HOME_SWITCH)
+	{
+		homing_start_back_off();
+		return;
+	}
+	
+	homing_seek_origin = get_motor_position();
+	homing_seek_distance = (homing_distance >= 0) ? homing_distance : -homing_distance;
+	homing_switch_found = false;
+	homing_set_phase(HOMING_SEEK);
+	
+	if (!set_jog_velocity((homing_direction_is_positive) ? homing_velocity : -(int32_t)homing_velocity))
+	{
+		homing_fail(0);
+	}
+}
+
+void homing_abort(void)
+{
+	homing_phase = HOMING_IDLE;
+}
+
+bool homing_update(void)
+{
+	bool motor_is_moving = motor_is_running || jog_is_active;
+	
+	switch (homing_phase)
+	{
+		case HOMING_IDLE:
+			break;
+		
+		case HOMING_SEEK:
+			if (motor_is_moving)
+			{
+				if (homing_switch_found) break;
+				
+				int32_t distance = get_motor_position() - homing_seek_origin;
+				if (distance < 0) distance = -distance;
+				
+				if (homing_seek_timeout && ++homing_phase_time > homing_seek_timeout)
+					homing_fail(REG_HOME_STEPS_EVENTS_B_TIMEOUT);
+				else if (distance >= homing_seek_distance)
+					homing_fail(0);
+			}
+			else
+			{
+				// Stopped without finding the switch, by a position limit or the stop switch
+				(homing_switch_found) ? homing_start_back_off() : homing_fail(0);
+			}
+			break;
+		
+		case HOMING_BACK_OFF:
+			if (motor_is_moving)
+			{
+				if (homing_back_off_timeout && ++homing_phase_time > homing_back_off_timeout)
+					homing_fail(REG_HOME_STEPS_EVENTS_B_TIMEOUT);
+			}
+			else
+			{
+				// The back off distance must be enough to release the switch
+				if (!read_HOME_SWITCH)
+					homing_fail(0);
+				else
+					homing_start_latch((homing_direction_is_positive) ? 2 * homing_back_off_distance : -2 * homing_back_off_distance);
+			}
+			break;
+		
+		case HOMING_LATCH:
+			// The switch and the end of the movement are reported as they happen
+			if (motor_is_running == false)
+			{
+				homing_set_phase(HOMING_IDLE);
+			}
+			else if (homing_latch_timeout && ++homing_phase_time > homing_latch_timeout)
+			{
+				stop_motor();
+				homing_fail(REG_HOME_STEPS_EVENTS_B_TIMEOUT);
+			}
+			break;
+	}
+	
+	if (homing_phase == homing_reported_phase) return false;
+	
+	homing_reported_phase = homing_phase;
+	return true;
+}
+
+enum HomingPhase homing_get_phase(void)
+{
+	return homing_phase;
+}
+
+ISR(PORTC_INT0_vect/*, ISR_NAKED*/)
+{
+	// The home switch input is low while it is active
+	bool is_active = (read_HOME_SWITCH) ? false : true;
+	if (is_active == home_switch_is_active) return;
+	home_switch_is_active = is_active;
+	
+	send_home_switch_notification = true;
+	if (is_active == false) return;
+	
+	// The step interrupt runs on the same level, so the position can't change while it is latched
+	home_switch_latch[0] = motor_current_position;
+	read_harp_timestamp((uint32_t*)&home_switch_latch[1], (uint32_t*)&home_switch_latch[2]);
+	
+	if (homing_phase == HOMING_SEEK)
+	{
+		// Decelerate past the switch, the origin is only set once it is found again at the minimum velocity
+		homing_switch_found = true;
+		quick_stop_motor();
+		home_switch_events = 0;
+	}
+	else
+	{
+		home_switch_events = (current_movement_status == MOVEMENT_STATUS_HOMING) ? REG_HOME_STEPS_EVENTS_B_HOMING_SUCCESSFUL : REG_HOME_STEPS_EVENTS_B_UNEXPECTED_HOME;
+		if (motor_is_running) stop_motor();
+	}
+	
+	send_home_switch_latch_notification = true;
+}
@@ -0,0 +1,35 @@
+#ifndef _HOMING_H_
+#define _HOMING_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Phases of the homing routine
+enum HomingPhase {HOMING_IDLE, HOMING_SEEK, HOMING_BACK_OFF, HOMING_LATCH};
+
+// Set the velocity of the fast approach to the switch (steps/s), 0 only uses the slow approach at the minimum velocity
+bool homing_set_velocity(uint32_t velocity);
+
+// Set the distance to back off from the switch (steps) and the timeout of each phase (ms, 0 disables it)
+bool homing_set_config(int32_t back_off_distance, int32_t seek_timeout, int32_t back_off_timeout, int32_t latch_timeout);
+
+// Start homing in the direction of homing_distance, never moving more than its absolute value on the fast approach
+void homing_start(int32_t homing_distance);
+
+// Stop the homing routine without reporting it (safe to call from an interrupt)
+void homing_abort(void);
+
+// Check the current phase and start the next one, returns true when the phase changed (called every ms)
+bool homing_update(void);
+
+// Get the current phase
+enum HomingPhase homing_get_phase(void);
+
+#endif /* _HOMING_H_ */
@@ -5,6 +5,13 @@
 #include "hwbp_core.h"
 
 #include "analog_input.h"
+#include "binary_link.h"
+#include "move_triggers.h"
+#include "acceleration_tune.h"
+#include "homing.h"
+#include "sequencer.h"
+#include "emergency_stop.h"
+#include "stepper_motor.h"
 
 /************************************************************************/
 /* Declare application registers                                        */
@@ -32,30 +39,28 @@ extern AppRegs app_regs;
 /* STOP                                                                 */
 /************************************************************************/
 extern bool motor_is_running;
+extern uint16_t emergency_stop_latency;
 
-ISR(PORTB_INT0_vect, ISR_NAKED)
+ISR(PORTB_INT0_vect/*, ISR_NAKED*/)
 {
-	if (read_STOP_SWITCH)
-	{
-		/* Update register and send event */
-		app_regs.REG_STOP_SWITCH = 0;
-		core_func_send_event(ADD_REG_STOP_SWITCH, true);
-	}
-	else
-	{		
-		/* Stop motor */
-		timer_type0_stop(&TCC0);
-		motor_is_running = false;
-		
-		/* Disable motor */
-		set_MOTOR_ENABLE;
-		
-		/* Update register and send event */
-		app_regs.REG_STOP_SWITCH = REG_STOP_SWITCH_B_STOP_SWITCH;
-		core_func_send_event(ADD_REG_STOP_SWITCH, true);
-	}
+	// The step pulses were already cut by the event system, so only the state is updated here
+	// The release of the switch is handled on the main loop by emergency_stop_release()
+	emergency_stop_record_latency();
 	
-	reti();
+	/* Stop motor */
+	if (motor_is_running) stop_motor();
+	autotune_abort();
+	homing_abort();
+	sequence_abort();
+	
+	/* Disable motor */
+	set_MOTOR_ENABLE;
+	
+	/* Update registers and send events */
+	app_regs.REG_STOP_LATENCY = emergency_stop_latency;
+	core_func_send_event(ADD_REG_STOP_LATENCY, true);
+	app_regs.REG_STOP_SWITCH = REG_STOP_SWITCH_B_STOP_SWITCH;
+	core_func_send_event(ADD_REG_STOP_SWITCH, true);
 }
 
 
@@ -70,3 +75,37 @@ ISR(ADCA_CH0_vect, ISR_NAKED)
 	reti();
 }
 
+
+/************************************************************************/
+/* Binary command link (USARTD0)                                        */
+/************************************************************************/
+ISR(USARTD0_RXC_vect/*, ISR_NAKED*/)
+{
+	BinaryLinkCommand command;
+	
+	// The error flags belong to the byte on the data register, so they are read before it
+	uint8_t status = USARTD0_STATUS;
+	
+	// Reading the data register clears the interrupt flag
+	uint8_t byte = USARTD0_DATA;
+	
+	if (status & (USART_FERR_bm | USART_BUFOVF_bm))
+	{
+		binary_link_drop_frame();
+		return;
+	}
+	
+	if (binary_link_parse_byte(byte, &command))
+	{
+		// Only the presets are started here, since they were planned ahead and their start just loads values
+		// The other commands change the planner state, which the main loop doesn't protect from this interrupt level
+		if (command.command == BINARY_LINK_CMD_PRESET)
+		{
+			if (command.argument >= 0 && command.argument <= MOVE_PRESETS_COUNT) start_move_preset(command.argument);
+		}
+		else
+		{
+			binary_link_queue_push(&command);
+		}
+	}
+}
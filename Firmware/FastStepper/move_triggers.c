@@ -0,0 +1,283 @@
+#include "move_triggers.h"
+#include "cpu.h"
+#include "hwbp_core.h"
+#include "stepper_motor.h"
+#include "app_ios_and_regs.h"
+#include "analog_follow.h"
+#include "homing.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Movement planned to start at the scheduled timestamp
+PreparedMove scheduled_move;
+
+// Harp timestamp when the scheduled movement should start
+uint32_t scheduled_move_second;
+uint32_t scheduled_move_microsecond;
+
+// Flag indicating there is a movement waiting for its start time
+bool scheduled_move_is_pending = false;
+
+// Flag indicating the start timer (TCD0) is counting down to the start time
+bool scheduled_move_timer_is_armed = false;
+
+// Difference between the time the movement started and the scheduled time (us)
+int32_t scheduled_move_error = 0;
+
+// Flag used by the interrupts to indicate the scheduled movement start should be reported
+bool send_scheduled_move_notification = false;
+
+// Movement planned to start on a trigger input edge
+PreparedMove trigger_move;
+
+// Target of the trigger movement, which can be relative to the position at the trigger
+int32_t trigger_move_target = 0;
+
+// Input edges that start the trigger movement (REG_TRIGGER_CONFIG bitmask)
+uint8_t trigger_config = 0;
+
+// Preset movement started by the trigger input edges (0 is the trigger movement)
+uint8_t trigger_preset = 0;
+
+// Movements planned beforehand, so a single byte is enough to start them
+PreparedMove move_presets[MOVE_PRESETS_COUNT];
+
+// Targets of the preset movements, which can be relative to the position at the start (bitmask)
+int32_t move_preset_targets[MOVE_PRESETS_COUNT];
+uint8_t move_presets_relative = 0;
+
+// Last state of the digital inputs seen by the interrupt
+uint8_t digital_inputs_previous_value = 0;
+
+// Flag used by the interrupts to indicate the digital inputs changed
+bool send_digital_inputs_notification = false;
+
+// Counts of R_TIMESTAMP_MICRO in one second (32 us each)
+#define TIMESTAMP_MICRO_COUNTS 31250
+
+// The start timer is armed when the scheduled time is closer than this (us)
+#define SCHEDULED_MOVE_ARM_WINDOW 2000
+
+
+extern int32_t motor_current_position;
+extern bool pvt_is_running;
+extern bool gearing_is_running;
+extern bool autotune_is_running;
+extern enum AnalogFollowMode analog_follow_mode;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+void read_harp_timestamp(uint32_t *second, uint32_t *microsecond)
+{
+	uint16_t micro;
+	
+	// Read again if the second changed between both reads
+	do
+	{
+		micro = core_func_read_R_TIMESTAMP_MICRO();
+		*second = core_func_read_R_TIMESTAMP_SECOND();
+	} while (core_func_read_R_TIMESTAMP_MICRO() < micro);
+	
+	// Inside an interrupt the TCC1 overflow can't be handled yet, so the second is still the old one after a wrap
+	if ((TCC1_INTFLAGS & TC1_OVFIF_bm) && micro < TIMESTAMP_MICRO_COUNTS / 2)
+	{
+		(*second)++;
+	}
+	
+	*microsecond = (uint32_t)micro * 32;
+}
+
+bool motor_is_taken(void)
+{
+	// A new target during the back off or the slow approach would redirect the homing movement
+	return (pvt_is_running || gearing_is_running || analog_follow_mode != ANALOG_FOLLOW_OFF || autotune_is_running || homing_get_phase() != HOMING_IDLE);
+}
+
+static int32_t time_since_scheduled_start(void)
+{
+	uint32_t second, microsecond;
+	read_harp_timestamp(&second, &microsecond);
+	
+	// Saturate far away times so the result fits in 32 bits
+	int32_t seconds = (int32_t)(second - scheduled_move_second);
+	if (seconds > 2) return 2000000;
+	if (seconds < -2) return -2000000;
+	
+	return seconds * 1000000 + (int32_t)microsecond - (int32_t)scheduled_move_microsecond;
+}
+
+static void start_scheduled_move(void)
+{
+	scheduled_move_is_pending = false;
+	scheduled_move_timer_is_armed = false;
+	
+	if (!motor_is_taken() && start_prepared_move(&scheduled_move))
+	{
+		scheduled_move_error = time_since_scheduled_start();
+	}
+	else
+	{
+		scheduled_move_error = SCHEDULED_MOVE_NOT_STARTED;
+	}
+	
+	// Send the start error from the main loop, since this code can run on an interrupt
+	send_scheduled_move_notification = true;
+}
+
+bool schedule_move(int32_t target_position, uint32_t second, uint32_t microsecond)
+{
+	if (microsecond >= 1000000) return false;
+	
+	cancel_scheduled_move();
+	
+	// All the planning is done now, so the start only needs to load the timer
+	prepare_move(&scheduled_move, target_position);
+	scheduled_move_second = second;
+	scheduled_move_microsecond = microsecond;
+	scheduled_move_is_pending = true;
+	
+	return true;
+}
+
+void cancel_scheduled_move(void)
+{
+	timer_type0_stop(&TCD0);
+	scheduled_move_timer_is_armed = false;
+	scheduled_move_is_pending = false;
+}
+
+void update_scheduled_move(void)
+{
+	if (scheduled_move_is_pending == false || scheduled_move_timer_is_armed) return;
+	
+	int32_t remaining_time = -time_since_scheduled_start();
+	
+	if (remaining_time > SCHEDULED_MOVE_ARM_WINDOW) return;
+	
+	// Too close (or already late) to arm the timer, so start right away
+	if (remaining_time < 4)
+	{
+		start_scheduled_move();
+		return;
+	}
+	
+	// The timer counts at 500 kHz (2 us per count) and the interrupt fires when the count reaches the target
+	scheduled_move_timer_is_armed = true;
+	timer_type0_enable(&TCD0, TIMER_PRESCALER_DIV64, (remaining_time >> 1) - 1, INT_LEVEL_HIGH);
+}
+
+void update_prepared_moves(void)
+{
+	if (prepared_moves_need_planning() == false) return;
+	
+	// The starts can happen on the interrupts, so the planning is only done here and they just load the result
+	if (scheduled_move_is_pending) replan_move(&scheduled_move);
+	replan_move(&trigger_move);
+	for (uint8_t i = 0; i < MOVE_PRESETS_COUNT; i++)
+		replan_move(&move_presets[i]);
+}
+
+ISR(TCD0_OVF_vect/*, ISR_NAKED*/)
+{
+	timer_type0_stop(&TCD0);
+	
+	if (scheduled_move_timer_is_armed) start_scheduled_move();
+}
+
+void prepare_trigger_move(int32_t target_position)
+{
+	trigger_move_target = target_position;
+	prepare_move(&trigger_move, target_position);
+}
+
+bool start_trigger_move(void)
+{
+	if (motor_is_taken()) return false;
+	
+	// Starting clamps the target to the position limits, so it is taken again every time, as with the presets
+	trigger_move.target_position = trigger_move_target;
+	if (trigger_config & REG_TRIGGER_CONFIG_B_RELATIVE)
+	{
+		trigger_move.target_position += motor_current_position;
+	}
+	return start_prepared_move(&trigger_move);
+}
+
+bool prepare_move_preset(uint8_t preset, int32_t target_position, bool is_relative)
+{
+	if (preset == 0 || preset > MOVE_PRESETS_COUNT) return false;
+	
+	uint8_t index = preset - 1;
+	prepare_move(&move_presets[index], target_position);
+	
+	/* Disable high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm;
+	move_preset_targets[index] = target_position;
+	(is_relative) ? (move_presets_relative |= (1 << index)) : (move_presets_relative &= ~(1 << index));
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+bool set_trigger_preset(uint8_t preset)
+{
+	if (preset > MOVE_PRESETS_COUNT) return false;
+	
+	trigger_preset = preset;
+	return true;
+}
+
+bool start_move_preset(uint8_t preset)
+{
+	// Same restrictions as REG_MOVE_TO, whether it's started by the register, the binary link or the trigger inputs
+	if (motor_is_taken()) return false;
+	
+	if (preset == 0) return start_trigger_move();
+	if (preset > MOVE_PRESETS_COUNT) return false;
+	
+	// Starting clamps the target to the position limits, so it is taken again from the preset every time
+	uint8_t index = preset - 1;
+	move_presets[index].target_position = move_preset_targets[index];
+	if (move_presets_relative & (1 << index))
+	{
+		move_presets[index].target_position += motor_current_position;
+	}
+	return start_prepared_move(&move_presets[index]);
+}
+
+uint8_t read_digital_inputs(void)
+{
+	uint8_t inputs = 0;
+	
+	if (read_INPUT_0) inputs |= REG_DIGITAL_INPUTS_B_INPUT_0;
+	if (read_INPUT_1) inputs |= REG_DIGITAL_INPUTS_B_INPUT_1;
+	
+	return inputs;
+}
+
+ISR(PORTD_INT0_vect/*, ISR_NAKED*/)
+{
+	uint8_t inputs = read_digital_inputs();
+	uint8_t changed = inputs ^ digital_inputs_previous_value;
+	digital_inputs_previous_value = inputs;
+	
+	// Translate the input changes into the edges used on REG_TRIGGER_CONFIG
+	uint8_t edges = 0;
+	if (changed & REG_DIGITAL_INPUTS_B_INPUT_0) edges |= (inputs & REG_DIGITAL_INPUTS_B_INPUT_0) ? REG_TRIGGER_CONFIG_B_INPUT_0_RISING : REG_TRIGGER_CONFIG_B_INPUT_0_FALLING;
+	if (changed & REG_DIGITAL_INPUTS_B_INPUT_1) edges |= (inputs & REG_DIGITAL_INPUTS_B_INPUT_1) ? REG_TRIGGER_CONFIG_B_INPUT_1_RISING : REG_TRIGGER_CONFIG_B_INPUT_1_FALLING;
+	
+	// The movement was planned beforehand, so only the timer needs to be loaded here
+	if (edges & trigger_config)
+	{
+		start_move_preset(trigger_preset);
+	}
+	
+	// Send the event from the main loop, since this interrupt runs on the highest level
+	if (changed) send_digital_inputs_notification = true;
+}
@@ -0,0 +1,58 @@
+#ifndef _MOVE_TRIGGERS_H_
+#define _MOVE_TRIGGERS_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Number of preset movements, besides the trigger movement (preset 0)
+#define MOVE_PRESETS_COUNT 4
+
+// Start error reported when the scheduled movement could not start because the motor was already moving
+#define SCHEDULED_MOVE_NOT_STARTED 0x7FFFFFFF
+
+// Read the Harp timestamp, with the microseconds converted from the 32 us resolution of R_TIMESTAMP_MICRO
+void read_harp_timestamp(uint32_t *second, uint32_t *microsecond);
+
+// Plan a movement to target_position that starts at the given Harp timestamp
+bool schedule_move(int32_t target_position, uint32_t second, uint32_t microsecond);
+
+// Cancel the scheduled movement, if any
+void cancel_scheduled_move(void);
+
+// Check if the scheduled movement is close enough to arm the start timer (called every ms)
+void update_scheduled_move(void);
+
+// Plan the scheduled, trigger and preset movements again after a change of the motion profile or the feed override (called every ms)
+void update_prepared_moves(void);
+
+// Plan the movement started by the trigger inputs
+void prepare_trigger_move(int32_t target_position);
+
+// Start the trigger movement, as if a trigger input edge happened
+bool start_trigger_move(void);
+
+// Plan the preset movement (1 to MOVE_PRESETS_COUNT), relative to the position at the start if is_relative is set
+bool prepare_move_preset(uint8_t preset, int32_t target_position, bool is_relative);
+
+// Select the preset movement started by the trigger inputs (0 is the trigger movement)
+bool set_trigger_preset(uint8_t preset);
+
+// Returns true while the streamed setpoints, the encoder, the analog input, the auto-tune or the homing have control of the motor
+// The movements to a target (registers, presets, scheduled movement, sequence and binary link) are refused meanwhile
+bool motor_is_taken(void);
+
+// Start a preset movement without any planning (0 is the trigger movement, safe to call from an interrupt)
+// Returns false if it didn't start, also when motor_is_taken()
+bool start_move_preset(uint8_t preset);
+
+// Read the current state of the digital inputs (REG_DIGITAL_INPUTS bitmask)
+uint8_t read_digital_inputs(void);
+
+#endif /* _MOVE_TRIGGERS_H_ */
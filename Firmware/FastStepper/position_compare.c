@@ -0,0 +1,290 @@
+#include "position_compare.h"
+#include "cpu.h"
+#include "app_ios_and_regs.h"
+#include "position_neighbours.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Trigger positions of an output and the triggers around the current position
+typedef struct
+{
+	bool is_enabled;
+	bool uses_table;
+	int32_t start;
+	int32_t interval;
+	int32_t count;
+	PositionNeighbours triggers;
+	uint16_t pulse_start;
+	bool pulse_is_high;
+} CompareOutput;
+
+// Flag indicating at least one output is enabled, checked by the step interrupt
+bool compare_is_enabled = false;
+
+// Width of the trigger pulses (us)
+uint16_t compare_pulse_width = 100;
+
+// Trigger positions used in table mode
+int32_t compare_table[COMPARE_TABLE_SIZE];
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+static bool compare_position_of(void *list, int32_t index, int32_t *position);
+
+CompareOutput compare_outputs[2] = {
+	{ .triggers = { .position_of = compare_position_of, .list = &compare_outputs[0] } },
+	{ .triggers = { .position_of = compare_position_of, .list = &compare_outputs[1] } }
+};
+
+// The pulses are timed with the compare channel B of the Harp timestamp timer (TCC1), which counts 32 us per tick up to one second
+#define COMPARE_TICK_US 32
+#define COMPARE_TIMER_PERIOD 31250
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern bool motor_is_running;
+extern int32_t motor_current_position;
+
+// Position of the trigger with the given index, returns false if there is no such trigger
+static bool compare_position_of(void *list, int32_t index, int32_t *position)
+{
+	CompareOutput *output = (CompareOutput*)list;
+	
+	if (index < 0) return false;
+	if (output->uses_table)
+	{
+		if (index >= output->count) return false;
+		*position = compare_table[index];
+		return true;
+	}
+	if (output->count != 0 && index >= output->count) return false;
+	*position = output->start + index * output->interval;
+	return true;
+}
+
+// The table entries used by an output must be strictly ascending
+static bool compare_table_is_valid(int32_t *table, int32_t count)
+{
+	if (count > COMPARE_TABLE_SIZE) return false;
+	
+	for (uint8_t i = 1; i < count; i++)
+	{
+		if (table[i] <= table[i-1]) return false;
+	}
+	
+	return true;
+}
+
+static void compare_sync_output(CompareOutput *output, int32_t position)
+{
+	if (output->uses_table)
+	{
+		position_neighbours_sync_table(&output->triggers, compare_table, output->count, position);
+		return;
+	}
+	
+	// The trigger exactly at the current position is not taken until the motor leaves it, since the motor is already there
+	int32_t distance = position - output->start;
+	int32_t index = distance / output->interval;
+	int32_t remainder = distance % output->interval;
+	
+	// Round towards minus infinity
+	if (remainder < 0) index--;
+	
+	int32_t up = index + 1;
+	int32_t down = (remainder == 0) ? index - 1 : index;
+	
+	if (up < 0) up = 0;
+	if (output->count != 0 && down >= output->count) down = output->count - 1;
+	
+	position_neighbours_sync(&output->triggers, up, down, position);
+}
+
+void position_compare_sync(void)
+{
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if (compare_outputs[i].is_enabled) compare_sync_output(&compare_outputs[i], motor_current_position);
+	}
+}
+
+bool position_compare_set_config(uint8_t output, int32_t start, int32_t interval, int32_t count)
+{
+	if (output > 1 || interval <= 0 || count < 0) return false;
+	if (compare_outputs[output].uses_table && !compare_table_is_valid(compare_table, count)) return false;
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	compare_outputs[output].start = start;
+	compare_outputs[output].interval = interval;
+	compare_outputs[output].count = count;
+	position_compare_sync();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+bool position_compare_set_table(int32_t *positions)
+{
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if (compare_outputs[i].uses_table && !compare_table_is_valid(positions, compare_outputs[i].count)) return false;
+	}
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	for (uint8_t i = 0; i < COMPARE_TABLE_SIZE; i++)
+		compare_table[i] = positions[i];
+	position_compare_sync();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+bool position_compare_set_pulse_width(uint16_t width)
+{
+	if (width == 0) return false;
+	
+	compare_pulse_width = width;
+	return true;
+}
+
+bool position_compare_enable(uint8_t outputs, uint8_t use_table)
+{
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if ((use_table & (1 << i)) && !compare_table_is_valid(compare_table, compare_outputs[i].count)) return false;
+	}
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		compare_outputs[i].is_enabled = (outputs & (1 << i)) ? true : false;
+		compare_outputs[i].uses_table = (use_table & (1 << i)) ? true : false;
+	}
+	compare_is_enabled = (compare_outputs[0].is_enabled || compare_outputs[1].is_enabled);
+	position_compare_sync();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	// A disabled output doesn't keep its pulse
+	if (!compare_outputs[0].is_enabled) { compare_outputs[0].pulse_is_high = false; clr_OUTPUT_0; }
+	if (!compare_outputs[1].is_enabled) { compare_outputs[1].pulse_is_high = false; clr_OUTPUT_1; }
+	
+	return true;
+}
+
+static void compare_set_output(uint8_t output, bool high)
+{
+	if (output == 0)
+	{
+		if (high) set_OUTPUT_0; else clr_OUTPUT_0;
+	}
+	else
+	{
+		if (high) set_OUTPUT_1; else clr_OUTPUT_1;
+	}
+}
+
+// TCC1 ticks since a pulse started, the count wraps every second
+// Must be called with the high level interrupts disabled, since the 16-bit read shares the TEMP register with the timestamp reads
+static uint16_t compare_ticks_since(uint16_t start)
+{
+	uint16_t now = TCC1_CNT;
+	return (now >= start) ? now - start : now + COMPARE_TIMER_PERIOD - start;
+}
+
+// End the pulses whose width elapsed and set the one-shot to the end of the next pulse
+// Must be called with the high level interrupts disabled
+static void compare_schedule_pulses(void)
+{
+	uint16_t width = (compare_pulse_width + COMPARE_TICK_US - 1) / COMPARE_TICK_US;
+	uint16_t remaining = 0;
+	
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if (compare_outputs[i].pulse_is_high == false) continue;
+		
+		uint16_t elapsed = compare_ticks_since(compare_outputs[i].pulse_start);
+		if (elapsed >= width)
+		{
+			compare_outputs[i].pulse_is_high = false;
+			compare_set_output(i, false);
+		}
+		else if (remaining == 0 || width - elapsed < remaining)
+		{
+			remaining = width - elapsed;
+		}
+	}
+	
+	if (remaining == 0)
+	{
+		TCC1_INTCTRLB &= ~TC1_CCBINTLVL_gm;
+		return;
+	}
+	
+	uint16_t end = TCC1_CNT + remaining;
+	if (end >= COMPARE_TIMER_PERIOD) end -= COMPARE_TIMER_PERIOD;
+	TCC1_CCB = end;
+	TCC1_INTFLAGS = TC1_CCBIF_bm;
+	TCC1_INTCTRLB = (TCC1_INTCTRLB & ~TC1_CCBINTLVL_gm) | TC_CCBINTLVL_MED_gc;
+	
+	// The count may have gone past the end while it was set, so that pulse is ended right away
+	if (compare_ticks_since(end) < COMPARE_TIMER_PERIOD / 2) compare_schedule_pulses();
+}
+
+// Start the pulse of an output, or restart it if it is still high from the previous trigger (called from medium level interrupts)
+static void compare_start_pulse(uint8_t output)
+{
+	/* Disable high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm;
+	compare_outputs[output].pulse_start = TCC1_CNT;
+	compare_outputs[output].pulse_is_high = true;
+	compare_set_output(output, true);
+	compare_schedule_pulses();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+ISR(TCC1_CCB_vect/*, ISR_NAKED*/)
+{
+	/* Disable high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm;
+	compare_schedule_pulses();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+void position_compare_on_step(int32_t position)
+{
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		if (compare_outputs[i].is_enabled == false) continue;
+		
+		int32_t index;
+		if (position_neighbours_on_step(&compare_outputs[i].triggers, position, &index)) compare_start_pulse(i);
+	}
+}
+
+void position_compare_update(void)
+{
+	if (compare_is_enabled == false || motor_is_running) return;
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	// The position may have been redefined while stopped
+	position_compare_sync();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
@@ -0,0 +1,40 @@
+#ifndef _POSITION_COMPARE_H_
+#define _POSITION_COMPARE_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Maximum number of positions on the trigger table
+#define COMPARE_TABLE_SIZE 8
+
+// Set the trigger positions of an output (0 or 1) at start + k*interval, for count triggers (0 for no limit)
+// When the output uses the table, start and interval are ignored and count is the number of table entries used
+bool position_compare_set_config(uint8_t output, int32_t start, int32_t interval, int32_t count);
+
+// Set the trigger positions used by the outputs in table mode, the entries used must be strictly ascending
+bool position_compare_set_table(int32_t *positions);
+
+// Set the width of the trigger pulses (us), rounded up to 32 us and timed in hardware independently of the steps
+// A trigger reached while the pulse is still high extends it, so the triggers must be further apart in time than the width
+bool position_compare_set_pulse_width(uint16_t width);
+
+// Enable the outputs (bit 0 for OUTPUT_0, bit 1 for OUTPUT_1) and select the ones that use the table (same bits)
+bool position_compare_enable(uint8_t outputs, uint8_t use_table);
+
+// Find the trigger positions around the current one again (call with the step interrupt disabled)
+void position_compare_sync(void);
+
+// Pulse the outputs whose trigger position was reached (called from the step interrupt)
+void position_compare_on_step(int32_t position);
+
+// Follow changes of the position while the motor is stopped, called from the main loop every 500 us
+void position_compare_update(void);
+
+#endif /* _POSITION_COMPARE_H_ */
@@ -0,0 +1,78 @@
+#include "position_neighbours.h"
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Positions that are never reached, meaning there is no entry in that direction
+#define NEIGHBOURS_NONE_UP INT32_MAX
+#define NEIGHBOURS_NONE_DOWN INT32_MIN
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+static void position_neighbours_move(PositionNeighbours *neighbours, int32_t index_up, int32_t index_down)
+{
+	neighbours->index_up = index_up;
+	neighbours->index_down = index_down;
+	if (!neighbours->position_of(neighbours->list, index_up, &neighbours->next_up)) neighbours->next_up = NEIGHBOURS_NONE_UP;
+	if (!neighbours->position_of(neighbours->list, index_down, &neighbours->next_down)) neighbours->next_down = NEIGHBOURS_NONE_DOWN;
+}
+
+void position_neighbours_sync(PositionNeighbours *neighbours, int32_t index_up, int32_t index_down, int32_t position)
+{
+	position_neighbours_move(neighbours, index_up, index_down);
+	
+	// Stopped exactly on the entry left out between both, which is taken again once the motor leaves it, in either direction
+	int32_t entry_position;
+	neighbours->is_at_entry = (index_up - index_down == 2 && neighbours->position_of(neighbours->list, index_up - 1, &entry_position) && entry_position == position);
+	if (neighbours->is_at_entry)
+	{
+		neighbours->entry_index = index_up - 1;
+		neighbours->entry_position = position;
+	}
+}
+
+void position_neighbours_sync_table(PositionNeighbours *neighbours, int32_t *table, int32_t count, int32_t position)
+{
+	// The entry exactly at the current position is left out until the motor leaves it, since the motor is already there
+	int32_t up = 0;
+	while (up < count && table[up] <= position) up++;
+	int32_t down = up - 1;
+	if (down >= 0 && table[down] == position) down--;
+	
+	position_neighbours_sync(neighbours, up, down, position);
+}
+
+int8_t position_neighbours_on_step(PositionNeighbours *neighbours, int32_t position, int32_t *index)
+{
+	// Once the motor leaves the entry just reached, it becomes the next one on the way back
+	if (neighbours->is_at_entry)
+	{
+		neighbours->is_at_entry = false;
+		if (position > neighbours->entry_position)
+		{
+			neighbours->index_down = neighbours->entry_index;
+			neighbours->next_down = neighbours->entry_position;
+		}
+		else
+		{
+			neighbours->index_up = neighbours->entry_index;
+			neighbours->next_up = neighbours->entry_position;
+		}
+	}
+	
+	int8_t direction;
+	if (position == neighbours->next_up) { *index = neighbours->index_up; direction = 1; }
+	else if (position == neighbours->next_down) { *index = neighbours->index_down; direction = -1; }
+	else return 0;
+	
+	position_neighbours_move(neighbours, *index + 1, *index - 1);
+	neighbours->entry_index = *index;
+	neighbours->entry_position = position;
+	neighbours->is_at_entry = true;
+	
+	return direction;
+}
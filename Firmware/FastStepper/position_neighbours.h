@@ -0,0 +1,40 @@
+#ifndef _POSITION_NEIGHBOURS_H_
+#define _POSITION_NEIGHBOURS_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Entries of an ascending list of positions (the compare triggers or the waypoints) around the motor position
+// Only these two entries are compared on each step, and they move along with every entry reached
+typedef struct
+{
+	// Gets the position of an entry of the list, returns false if there is no such entry
+	bool (*position_of)(void *list, int32_t index, int32_t *position);
+	void *list;
+	int32_t index_up;
+	int32_t index_down;
+	int32_t next_up;
+	int32_t next_down;
+	bool is_at_entry;
+	int32_t entry_index;
+	int32_t entry_position;
+} PositionNeighbours;
+
+// Set the entries around the current position, index_down is -1 when there is none below
+// If the entry between both is at the position itself, it is taken again as soon as the motor leaves it
+void position_neighbours_sync(PositionNeighbours *neighbours, int32_t index_up, int32_t index_down, int32_t position);
+
+// Find the entries around the position on an ascending table, the entry at the position itself is only taken once the motor leaves it
+void position_neighbours_sync_table(PositionNeighbours *neighbours, int32_t *table, int32_t count, int32_t position);
+
+// Follow a step of the motor, returns 1 or -1 (direction) when an entry was reached and writes its index, 0 otherwise
+int8_t position_neighbours_on_step(PositionNeighbours *neighbours, int32_t position, int32_t *index);
+
+#endif /* _POSITION_NEIGHBOURS_H_ */
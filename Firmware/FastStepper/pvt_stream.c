@@ -0,0 +1,244 @@
+#include "pvt_stream.h"
+#include "app_ios_and_regs.h"
+#include "stepper_motor.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Flag indicating the motor is following the streamed setpoints
+bool pvt_is_running = false;
+
+// Flag indicating the motor is decelerating to leave the streaming mode
+bool pvt_is_stopping = false;
+
+// Flag indicating the FIFO ran empty while the last setpoint was still moving
+bool pvt_underrun = false;
+
+// Flag used to indicate a segment was consumed and the fill level should be reported
+bool send_pvt_fill_notification = false;
+
+// Flag used to indicate an underrun happened and should be reported
+bool send_pvt_underrun_notification = false;
+
+// Time between calls to pvt_update (s)
+#define PVT_UPDATE_PERIOD 0.001
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Setpoints FIFO
+int32_t pvt_fifo_position[PVT_FIFO_SIZE];
+int32_t pvt_fifo_velocity[PVT_FIFO_SIZE];
+uint16_t pvt_fifo_duration[PVT_FIFO_SIZE];
+uint8_t pvt_fifo_head = 0;
+uint8_t pvt_fifo_count = 0;
+
+// Current segment, going from (start position, start velocity) to (end position, end velocity)
+int32_t pvt_segment_start_position;
+float pvt_segment_start_velocity;
+float pvt_segment_distance;
+float pvt_segment_end_velocity;
+// Duration of the current segment and time elapsed since it started (s)
+float pvt_segment_duration;
+float pvt_segment_time;
+
+// Velocity commanded on the last update (steps/s)
+float pvt_commanded_velocity = 0;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern float motor_acceleration;
+extern float motor_deceleration;
+extern bool motor_is_running;
+extern bool jog_is_active;
+extern bool gearing_is_running;
+extern float feed_override;
+extern uint8_t position_limit_events;
+extern AppRegs app_regs;
+
+bool pvt_push_point(int32_t position, int32_t velocity, uint16_t duration)
+{
+	if (pvt_fifo_count >= PVT_FIFO_SIZE || duration == 0) return false;
+	
+	uint8_t index = pvt_fifo_head + pvt_fifo_count;
+	if (index >= PVT_FIFO_SIZE) index -= PVT_FIFO_SIZE;
+	
+	pvt_fifo_position[index] = position;
+	pvt_fifo_velocity[index] = velocity;
+	pvt_fifo_duration[index] = duration;
+	
+	// The count is also changed by pvt_update(), so it is updated with the low level interrupts disabled
+	/* Disable low level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	pvt_fifo_count++;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+uint8_t pvt_get_fill_level(void)
+{
+	return pvt_fifo_count;
+}
+
+// Start a new segment from the end of the current one (or from the hold position) to the next setpoint
+static bool pvt_next_segment(int32_t start_position, float start_velocity)
+{
+	pvt_segment_start_position = start_position;
+	pvt_segment_start_velocity = start_velocity;
+	
+	if (pvt_fifo_count == 0)
+	{
+		// Nothing else to follow, so hold at the last position
+		pvt_segment_distance = 0;
+		pvt_segment_end_velocity = 0;
+		pvt_segment_start_velocity = 0;
+		pvt_segment_duration = 0;
+		pvt_segment_time = 0;
+		return false;
+	}
+	
+	pvt_segment_distance = (float)(pvt_fifo_position[pvt_fifo_head] - start_position);
+	pvt_segment_end_velocity = (float)pvt_fifo_velocity[pvt_fifo_head];
+	pvt_segment_duration = pvt_fifo_duration[pvt_fifo_head] * 0.000001;
+	
+	/* Disable low level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	if (++pvt_fifo_head >= PVT_FIFO_SIZE) pvt_fifo_head = 0;
+	pvt_fifo_count--;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	send_pvt_fill_notification = true;
+	return true;
+}
+
+bool pvt_start(void)
+{
+	if (pvt_is_running || pvt_fifo_count == 0) return false;
+	
+	// Streaming takes over the motor, so it can't start on top of another movement
+	if (motor_is_running || jog_is_active || gearing_is_running) return false;
+	
+	pvt_underrun = false;
+	pvt_is_stopping = false;
+	position_limit_events = 0;
+	pvt_commanded_velocity = 0;
+	pvt_segment_time = 0;
+	pvt_next_segment(get_motor_position(), 0);
+	pvt_is_running = true;
+	
+	return true;
+}
+
+void pvt_stop(void)
+{
+	pvt_fifo_count = 0;
+	if (pvt_is_running) pvt_is_stopping = true;
+}
+
+void pvt_clear(void)
+{
+	pvt_fifo_count = 0;
+}
+
+void pvt_abort(void)
+{
+	pvt_fifo_count = 0;
+	pvt_is_running = false;
+	pvt_is_stopping = false;
+}
+
+// Limit the change of the commanded velocity to the configured acceleration and deceleration
+static float pvt_limit_velocity(float velocity)
+{
+	float magnitude = (pvt_commanded_velocity >= 0) ? pvt_commanded_velocity : -pvt_commanded_velocity;
+	float target_magnitude = (velocity >= 0) ? velocity : -velocity;
+	bool speeding_up = (target_magnitude > magnitude) && ((velocity >= 0) == (pvt_commanded_velocity >= 0));
+	
+	float deceleration = (motor_deceleration < 0) ? -motor_deceleration : motor_deceleration;
+	float max_change = ((speeding_up) ? motor_acceleration : deceleration) * PVT_UPDATE_PERIOD;
+	
+	if (velocity > pvt_commanded_velocity + max_change) return pvt_commanded_velocity + max_change;
+	if (velocity < pvt_commanded_velocity - max_change) return pvt_commanded_velocity - max_change;
+	return velocity;
+}
+
+void pvt_update(void)
+{
+	if (pvt_is_running == false) return;
+	
+	// Leave the streaming mode if the motor was disabled, the stop switch was hit or a position limit was reached
+	if (!read_STOP_SWITCH || !(app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_MOTOR) || position_limit_events)
+	{
+		pvt_abort();
+		return;
+	}
+	
+	int32_t position = get_motor_position();
+	float velocity;
+	
+	if (pvt_is_stopping)
+	{
+		velocity = pvt_limit_velocity(0);
+	}
+	else
+	{
+		// The feed override scales the time of the stream, so the setpoint positions don't change
+		pvt_segment_time += PVT_UPDATE_PERIOD*feed_override;
+		
+		// Move to the next segment when the current one is over, carrying the extra time into it
+		while (pvt_segment_duration > 0 && pvt_segment_time >= pvt_segment_duration)
+		{
+			float extra_time = pvt_segment_time - pvt_segment_duration;
+			int32_t end_position = pvt_segment_start_position + (int32_t)pvt_segment_distance;
+			bool moving = (pvt_segment_end_velocity != 0);
+			
+			if (pvt_next_segment(end_position, pvt_segment_end_velocity) == false && moving)
+			{
+				pvt_underrun = true;
+				send_pvt_underrun_notification = true;
+			}
+			pvt_segment_time = extra_time;
+		}
+		
+		// Cubic Hermite interpolation between the segment end points
+		float desired_position_offset;
+		float desired_velocity;
+		if (pvt_segment_duration > 0)
+		{
+			float T = pvt_segment_duration;
+			float s = pvt_segment_time / T;
+			float s2 = s * s;
+			float s3 = s2 * s;
+			
+			desired_position_offset = (s3 - 2*s2 + s) * T * pvt_segment_start_velocity + (-2*s3 + 3*s2) * pvt_segment_distance + (s3 - s2) * T * pvt_segment_end_velocity;
+			desired_velocity = (3*s2 - 4*s + 1) * pvt_segment_start_velocity + (-6*s2 + 6*s) * pvt_segment_distance / T + (3*s2 - 2*s) * pvt_segment_end_velocity;
+		}
+		else
+		{
+			desired_position_offset = 0;
+			desired_velocity = 0;
+		}
+		
+		// Correct the velocity with the position error, so the motor doesn't drift from the path
+		float position_error = (float)(pvt_segment_start_position - position) + desired_position_offset;
+		velocity = pvt_limit_velocity(desired_velocity*feed_override + PVT_POSITION_GAIN * position_error);
+	}
+	
+	pvt_commanded_velocity = velocity;
+	run_motor_at_velocity(velocity);
+	
+	if (pvt_is_stopping && velocity == 0)
+	{
+		pvt_is_running = false;
+		pvt_is_stopping = false;
+	}
+}
@@ -0,0 +1,41 @@
+#ifndef _PVT_STREAM_H_
+#define _PVT_STREAM_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Number of setpoints the FIFO can hold
+#define PVT_FIFO_SIZE 16
+
+// Gain applied to the position error to correct the commanded velocity (1/s)
+#define PVT_POSITION_GAIN 50.0
+
+// Add a setpoint to reach position (steps) with velocity (steps/s), duration (us) after the previous one
+bool pvt_push_point(int32_t position, int32_t velocity, uint16_t duration);
+
+// Start following the setpoints on the FIFO, beginning from the current position at rest
+bool pvt_start(void);
+
+// Decelerate to a stop and clear the FIFO
+void pvt_stop(void);
+
+// Discard the setpoints on the FIFO, holding at the end of the current segment
+void pvt_clear(void);
+
+// Immediately leave the streaming mode and clear the FIFO, without commanding the motor
+void pvt_abort(void);
+
+// Number of setpoints on the FIFO
+uint8_t pvt_get_fill_level(void);
+
+// Interpolate the current segment and update the motor velocity (called every ms)
+void pvt_update(void);
+
+#endif /* _PVT_STREAM_H_ */
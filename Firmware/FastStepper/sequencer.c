@@ -0,0 +1,292 @@
+#include "sequencer.h"
+#include "cpu.h"
+#include "app_ios_and_regs.h"
+#include "stepper_motor.h"
+#include "move_triggers.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Flag indicating the sequence is running
+bool sequence_is_running = false;
+
+// Flags indicating how the last sequence ended
+bool sequence_is_done = false;
+bool sequence_failed = false;
+
+// Instructions of the sequence, not copied to save RAM
+int32_t *sequence_instructions;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Instruction being executed
+uint8_t sequence_index;
+
+// Flag indicating the instruction is waiting for its condition
+bool sequence_is_waiting;
+
+// Time left on SEQUENCE_OP_WAIT_TIME (ms)
+uint32_t sequence_wait_time;
+
+// Side of the SEQUENCE_OP_WAIT_POSITION position the motor was on when the wait started
+bool sequence_wait_from_below;
+
+// Target of the movement being waited for, the sequence fails if the motor stops somewhere else
+int32_t sequence_move_target;
+
+// Passes left on each loop, plus one (0 when the loop is not active)
+uint16_t sequence_loop_counters[SEQUENCE_SIZE];
+
+// Flag used by the interrupts to request the sequence to stop
+bool sequence_abort_requested = false;
+
+// Flag used by the host commands to end the sequence, leaving the motor to them
+bool sequence_release_requested = false;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern bool motor_is_running;
+extern AppRegs app_regs;
+
+#define SEQUENCE_OPCODE(instruction) ((uint8_t)((uint32_t)(instruction) >> 24))
+
+// Sign extend the 24 bits argument
+#define SEQUENCE_ARGUMENT(instruction) (((int32_t)((uint32_t)(instruction) << 8)) >> 8)
+
+// The outputs pulsed by the position compare can't be driven by the sequence
+static bool sequence_outputs_are_free(int32_t argument)
+{
+	uint8_t compare_outputs = app_regs.REG_COMPARE_CONTROL & (REG_COMPARE_CONTROL_B_OUTPUT_0 | REG_COMPARE_CONTROL_B_OUTPUT_1);
+	return ((argument & compare_outputs) == 0);
+}
+
+bool sequence_is_valid(int32_t *instructions)
+{
+	for (uint8_t i = 0; i < SEQUENCE_SIZE; i++)
+	{
+		if (SEQUENCE_OPCODE(instructions[i]) > SEQUENCE_OP_LOOP) return false;
+		if (SEQUENCE_OPCODE(instructions[i]) == SEQUENCE_OP_LOOP && (instructions[i] & 0xFF) >= SEQUENCE_SIZE) return false;
+	}
+	
+	return true;
+}
+
+bool sequence_start(int32_t *instructions)
+{
+	if (sequence_is_running || !sequence_is_valid(instructions)) return false;
+	
+	for (uint8_t i = 0; i < SEQUENCE_SIZE; i++)
+	{
+		if (SEQUENCE_OPCODE(instructions[i]) == SEQUENCE_OP_SET_OUTPUTS && !sequence_outputs_are_free(SEQUENCE_ARGUMENT(instructions[i]))) return false;
+	}
+	
+	for (uint8_t i = 0; i < SEQUENCE_SIZE; i++)
+		sequence_loop_counters[i] = 0;
+	
+	sequence_instructions = instructions;
+	sequence_index = 0;
+	sequence_is_waiting = false;
+	sequence_abort_requested = false;
+	sequence_release_requested = false;
+	sequence_is_done = false;
+	sequence_failed = false;
+	sequence_is_running = true;
+	
+	return true;
+}
+
+void sequence_abort(void)
+{
+	if (sequence_is_running == false) return;
+	
+	// The sequence ends on the main loop
+	sequence_abort_requested = true;
+	quick_stop_motor();
+}
+
+void sequence_release(void)
+{
+	if (sequence_is_running == false) return;
+	
+	// The sequence ends on the main loop, and the motor keeps following the command that took it
+	sequence_release_requested = true;
+}
+
+uint8_t sequence_get_index(void)
+{
+	return sequence_index;
+}
+
+static void sequence_finish(bool failed)
+{
+	sequence_is_running = false;
+	sequence_is_done = !failed;
+	sequence_failed = failed;
+}
+
+// Check if the condition the instruction waits for is met
+static bool sequence_wait_is_over(int32_t instruction)
+{
+	int32_t argument = SEQUENCE_ARGUMENT(instruction);
+	
+	switch (SEQUENCE_OPCODE(instruction))
+	{
+		case SEQUENCE_OP_MOVE_TO:
+		case SEQUENCE_OP_MOVE_BY:
+			return (motor_is_running == false);
+		
+		case SEQUENCE_OP_WAIT_TIME:
+			return (--sequence_wait_time == 0);
+		
+		case SEQUENCE_OP_WAIT_INPUTS:
+		{
+			uint8_t mask = argument & 0xFF;
+			return ((read_digital_inputs() & mask) == ((argument >> 8) & mask));
+		}
+		
+		case SEQUENCE_OP_WAIT_POSITION:
+			return (sequence_wait_from_below) ? (get_motor_position() >= argument) : (get_motor_position() <= argument);
+	}
+	
+	return true;
+}
+
+// Execute one instruction, returns false if the sequence can't go on
+static bool sequence_execute(int32_t instruction)
+{
+	int32_t argument = SEQUENCE_ARGUMENT(instruction);
+	
+	switch (SEQUENCE_OPCODE(instruction))
+	{
+		case SEQUENCE_OP_MOVE_TO:
+		case SEQUENCE_OP_MOVE_BY:
+		{
+			int32_t target = (SEQUENCE_OPCODE(instruction) == SEQUENCE_OP_MOVE_TO) ? argument : get_motor_position() + argument;
+			
+			// The next instructions expect the motor at the target, so a movement that is clamped or doesn't start fails the sequence
+			if (!position_is_within_limits(target)) return false;
+			
+			// Already there, so there is nothing to move or to wait for
+			if (target == get_motor_position()) break;
+			
+			if (!move_to_target_position(target)) return false;
+			sequence_move_target = target;
+			sequence_is_waiting = true;
+			break;
+		}
+		
+		case SEQUENCE_OP_VELOCITY:
+			if (!set_jog_velocity(argument)) return false;
+			break;
+		
+		case SEQUENCE_OP_WAIT_TIME:
+			sequence_wait_time = argument;
+			sequence_is_waiting = (argument > 0);
+			break;
+		
+		case SEQUENCE_OP_WAIT_INPUTS:
+			sequence_is_waiting = !sequence_wait_is_over(instruction);
+			break;
+		
+		case SEQUENCE_OP_WAIT_POSITION:
+			sequence_wait_from_below = (get_motor_position() < argument);
+			sequence_is_waiting = !sequence_wait_is_over(instruction);
+			break;
+		
+		case SEQUENCE_OP_SET_OUTPUTS:
+			// The position compare may have been enabled after the sequence started
+			if (!sequence_outputs_are_free(argument)) return false;
+			if (argument & (1<<0)) { if (argument & (1<<8)) set_OUTPUT_0; else clr_OUTPUT_0; }
+			if (argument & (1<<1)) { if (argument & (1<<9)) set_OUTPUT_1; else clr_OUTPUT_1; }
+			break;
+		
+		case SEQUENCE_OP_LOOP:
+		{
+			uint16_t passes = (uint16_t)(argument >> 8);
+			uint16_t *counter = &sequence_loop_counters[sequence_index];
+			
+			if (passes == 0)
+			{
+				sequence_index = argument & 0xFF;
+				return true;
+			}
+			
+			if (*counter == 0) *counter = passes;
+			if (*counter > 1)
+			{
+				(*counter)--;
+				sequence_index = argument & 0xFF;
+				return true;
+			}
+			
+			// Leave the loop ready for the next time it is reached
+			*counter = 0;
+			break;
+		}
+	}
+	
+	if (sequence_is_waiting == false) sequence_index++;
+	return true;
+}
+
+bool sequence_update(void)
+{
+	if (sequence_is_running == false) return false;
+	
+	if (sequence_abort_requested)
+	{
+		if (motor_is_running) return false;
+		sequence_finish(true);
+		return true;
+	}
+	
+	// A host command or another control mode took over the motor
+	if (sequence_release_requested || motor_is_taken())
+	{
+		sequence_finish(true);
+		return true;
+	}
+	
+	// Run the instructions that don't wait right away, but never loop forever on a single tick
+	for (uint8_t executed = 0; executed < SEQUENCE_SIZE; executed++)
+	{
+		if (sequence_is_waiting)
+		{
+			if (!sequence_wait_is_over(sequence_instructions[sequence_index])) return false;
+			sequence_is_waiting = false;
+			
+			// Stopped short of the target, by a position limit, the stop switch, the home switch or a stop command
+			uint8_t opcode = SEQUENCE_OPCODE(sequence_instructions[sequence_index]);
+			if ((opcode == SEQUENCE_OP_MOVE_TO || opcode == SEQUENCE_OP_MOVE_BY) && get_motor_position() != sequence_move_target)
+			{
+				sequence_finish(true);
+				return true;
+			}
+			
+			sequence_index++;
+		}
+		
+		if (sequence_index >= SEQUENCE_SIZE || SEQUENCE_OPCODE(sequence_instructions[sequence_index]) == SEQUENCE_OP_END)
+		{
+			sequence_finish(false);
+			return true;
+		}
+		
+		if (!sequence_execute(sequence_instructions[sequence_index]))
+		{
+			sequence_finish(true);
+			return true;
+		}
+		
+		if (sequence_is_waiting) return false;
+	}
+	
+	return false;
+}
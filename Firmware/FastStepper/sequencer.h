@@ -0,0 +1,50 @@
+#ifndef _SEQUENCER_H_
+#define _SEQUENCER_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+/************************************************************************/
+/* Instruction format (I32)                                             */
+/*                                                                      */
+/* [OPCODE (bits 31-24)] [ARGUMENT (bits 23-0, signed)]                 */
+/************************************************************************/
+#define SEQUENCE_OP_END             0x00    // Ends the sequence
+#define SEQUENCE_OP_MOVE_TO         0x01    // Argument: target position (steps), waits until the motor stops. Fails if the target is outside the position limits, no movement starts or the motor stops elsewhere. Already at the target, it goes on right away.
+#define SEQUENCE_OP_MOVE_BY         0x02    // Argument: distance from the current position (steps), waits until the motor stops. Fails as SEQUENCE_OP_MOVE_TO.
+#define SEQUENCE_OP_VELOCITY        0x03    // Argument: same as REG_DIRECT_VELOCITY, doesn't wait
+#define SEQUENCE_OP_WAIT_TIME       0x04    // Argument: time to wait (ms)
+#define SEQUENCE_OP_WAIT_INPUTS     0x05    // Argument: REG_DIGITAL_INPUTS mask (bits 7-0) and state to wait for (bits 15-8)
+#define SEQUENCE_OP_WAIT_POSITION   0x06    // Argument: position the motor must reach or pass (steps)
+#define SEQUENCE_OP_SET_OUTPUTS     0x07    // Argument: outputs mask (bits 7-0, bit 0 is OUTPUT_0) and their state (bits 15-8). Fails on the outputs enabled on REG_COMPARE_CONTROL.
+#define SEQUENCE_OP_LOOP            0x08    // Argument: instruction to jump to (bits 7-0) and number of passes (bits 23-8, 0 repeats forever)
+
+// Maximum number of instructions
+#define SEQUENCE_SIZE 16
+
+// Check the opcodes and the jumps of the instructions
+bool sequence_is_valid(int32_t *instructions);
+
+// Start the sequence from the first instruction (the instructions are not copied, so they can't change while it runs)
+bool sequence_start(int32_t *instructions);
+
+// Stop the sequence and the movement it started (safe to call from an interrupt)
+void sequence_abort(void);
+
+// End the sequence because a host command took the motor, which is not stopped (safe to call from an interrupt)
+void sequence_release(void);
+
+// Run the instructions until one has to wait, returns true when the sequence ends (called every ms)
+bool sequence_update(void);
+
+// Get the instruction being executed
+uint8_t sequence_get_index(void);
+
+#endif /* _SEQUENCER_H_ */
@@ -1,5 +1,10 @@
 #include "stepper_motor.h"
 #include "app_ios_and_regs.h"
+#include "trace_capture.h"
+#include "move_triggers.h"
+#include "emergency_stop.h"
+#include "position_compare.h"
+#include "waypoints.h"
 
 #include "math.h"
 
@@ -25,6 +30,22 @@ float motor_current_jerk = 0;
 
 uint32_t motor_current_braking_distance = 0;
 
+// Braking distance from the maximum velocity, planned with the motion profile so it isn't calculated while cruising
+uint32_t motor_cruise_braking_distance = 0;
+uint32_t pending_cruise_braking_distance = 0;
+
+// Flag indicating the last velocity update was limited to the maximum velocity
+bool motor_is_at_maximum_velocity = false;
+
+// Flag indicating the motion profile or the feed override changed since the prepared movements were planned
+bool prepared_moves_are_stale = false;
+
+// Step periods of the first steps of the current movement, copied from its prepared movement
+uint16_t motor_ramp_periods[PREPARED_MOVE_RAMP_STEPS];
+// Number of ramp steps of the current movement and index of the next one loaded by the step interrupt
+uint8_t motor_ramp_length = 0;
+uint8_t motor_ramp_index = 0;
+
 
 // Minimum velocity of the motor set by the user
 uint16_t motor_minimum_velocity = 400;
@@ -45,6 +66,18 @@ float motor_acceleration_jerk = 500;
 float motor_deceleration_jerk = -500;
 
 
+// Deceleration used by the quick stop
+float motor_quick_stop_deceleration = -20000;
+
+// Jerk used by the quick stop to ramp the deceleration in and out
+float motor_quick_stop_jerk = -400000;
+
+
+// Motion profile waiting for the motor to stop to be applied
+MotionProfile pending_motion_profile;
+bool motion_profile_is_pending = false;
+
+
 
 // Maximum step period allowed (this corresponds to the minimum allowed velocity, a little over 15 steps/s)
 const uint16_t MOTOR_MAX_STEP_PERIOD = 65535;
@@ -74,12 +107,268 @@ int32_t motor_target_position = 0;
 // Flag indicating if the motor is currently moving
 bool motor_is_running = false;
 
+// Flag indicating the motor stops at motor_target_position (false while under velocity control)
+bool motor_has_target = true;
+
+// Direction used to count the steps while under velocity control
+bool motor_direction_is_positive = true;
+
+// Flag indicating a quick stop was requested and should be started from the main loop
+bool motor_quick_stop_requested = false;
+
+// Flag indicating the motor is ramping towards jog_target_velocity
+bool jog_is_active = false;
+
+// Signed target velocity of the jog mode (steps/s)
+int32_t jog_target_velocity = 0;
+
+// Signed velocity and acceleration of the jog ramp
+float jog_velocity = 0;
+float jog_acceleration = 0;
+
+// Time between calls to update_jog_velocity (s)
+#define JOG_UPDATE_PERIOD 0.0005
+
+// Time scale applied to the movements to a target and to the streamed setpoints (1.0 is 100%)
+float feed_override = 1.0;
+
+// Time scale requested by the user, which feed_override ramps to
+float feed_override_target = 1.0;
+
+// Flag indicating the software position limits are enforced
+bool position_limits_enabled = false;
+
+// Software position limits (steps)
+int32_t position_limit_minimum = -2147483647;
+int32_t position_limit_maximum = 2147483647;
+
+// Steps the motor can still take under velocity control before reaching the limit in its direction
+int32_t motor_steps_until_limit = 0x7FFFFFFF;
+
+// Limit reached or clamped to (REG_POSITION_LIMIT_EVENTS bitmask), cleared when a new movement is requested
+uint8_t position_limit_events = 0;
+
+// Flag used by the interrupts to indicate a position limit event should be sent
+bool send_position_limit_notification = false;
+
+// Flag indicating the current movement is reported on REG_MOVE_TO_EVENTS when it ends
+bool move_report_is_active = false;
+
+// Harp timestamp of the start of the current movement
+uint32_t move_start_second;
+uint32_t move_start_microsecond;
+
+// Highest velocity reached during the current movement (steps/s)
+float move_peak_velocity = 0;
+
+// Report of the last movement that ended
+MoveReport move_report;
+
+// Flag used by the interrupts to indicate the movement report should be sent
+bool send_move_report_notification = false;
+
 /************************************************************************/
 /* Functions                                                            */
 /************************************************************************/
 
 
-float calculate_braking_distance()
+// Braking distance from a velocity above the minimum velocity (see calculate_braking_distance)
+static float braking_distance(float velocity, float deceleration, float deceleration_jerk);
+
+// Step period for a velocity of the target planner, scaled by the feed override
+static uint16_t scaled_step_period(float velocity)
+{
+	float period = 1000000/(velocity*feed_override);
+	
+	if (period > MOTOR_MAX_STEP_PERIOD) return MOTOR_MAX_STEP_PERIOD;
+	if (period < MOTOR_MIN_STEP_PERIOD) return MOTOR_MIN_STEP_PERIOD;
+	return (uint16_t)period;
+}
+
+
+// Part of the feed override above 100 %, where the target planner keeps its acceleration and jerk in real time
+// Scaling them with the time as well would take the real acceleration and jerk over the motion profile (a*s^2, j*s^3)
+static float feed_override_overdrive(void)
+{
+	if (current_movement_status == MOVEMENT_STATUS_STOPPING || feed_override <= 1.0) return 1.0;
+	return feed_override;
+}
+
+
+// Must be called with the medium and high level interrupts disabled (or from an interrupt)
+static void update_steps_until_limit(void)
+{
+	if (position_limits_enabled == false)
+	{
+		motor_steps_until_limit = 0x7FFFFFFF;
+		return;
+	}
+	
+	motor_steps_until_limit = (motor_direction_is_positive) ? (position_limit_maximum - motor_current_position) : (motor_current_position - position_limit_minimum);
+}
+
+
+// Must be called with the medium and high level interrupts disabled (or from an interrupt)
+static void report_position_limit(bool positive)
+{
+	position_limit_events = (positive) ? REG_POSITION_LIMIT_EVENTS_B_MAXIMUM : REG_POSITION_LIMIT_EVENTS_B_MINIMUM;
+	send_position_limit_notification = true;
+	
+	// Velocity control from the jog mode can't go on towards the limit
+	jog_is_active = false;
+}
+
+
+static int32_t clamp_to_position_limits(int32_t target_position)
+{
+	if (position_limits_enabled == false) return target_position;
+	
+	if (target_position > position_limit_maximum)
+	{
+		position_limit_events = REG_POSITION_LIMIT_EVENTS_B_MAXIMUM | REG_POSITION_LIMIT_EVENTS_B_TARGET_CLAMPED;
+		send_position_limit_notification = true;
+		return position_limit_maximum;
+	}
+	if (target_position < position_limit_minimum)
+	{
+		position_limit_events = REG_POSITION_LIMIT_EVENTS_B_MINIMUM | REG_POSITION_LIMIT_EVENTS_B_TARGET_CLAMPED;
+		send_position_limit_notification = true;
+		return position_limit_minimum;
+	}
+	
+	return target_position;
+}
+
+
+static void start_move_report(void)
+{
+	read_harp_timestamp(&move_start_second, &move_start_microsecond);
+	move_peak_velocity = motor_current_velocity;
+	move_report_is_active = true;
+}
+
+
+// Must be called with the medium and high level interrupts disabled (or from an interrupt)
+static void end_move_report(uint8_t reason)
+{
+	if (move_report_is_active == false) return;
+	move_report_is_active = false;
+	
+	read_harp_timestamp(&move_report.second, &move_report.microsecond);
+	
+	// Saturate very long movements so the duration fits in 32 bits
+	uint32_t seconds = move_report.second - move_start_second;
+	if (seconds > 2000)
+	{
+		move_report.duration = 0x7FFFFFFF;
+	}
+	else
+	{
+		move_report.duration = (int32_t)seconds * 1000000 + (int32_t)move_report.microsecond - (int32_t)move_start_microsecond;
+	}
+	
+	move_report.reason = reason;
+	move_report.peak_velocity = (int32_t)move_peak_velocity;
+	move_report.position_error = motor_target_position - motor_current_position;
+	send_move_report_notification = true;
+}
+
+
+bool get_move_report(MoveReport *report)
+{
+	if (send_move_report_notification == false) return false;
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	*report = move_report;
+	send_move_report_notification = false;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+
+// Called with the low and high level interrupts disabled, since the prepared movements also apply it when they start
+static void apply_motion_profile(void)
+{
+	// Changing the parameters in the middle of a movement would break the braking distance estimation
+	if (motion_profile_is_pending == false || motor_is_running) return;
+	
+	motor_minimum_velocity = pending_motion_profile.minimum_velocity;
+	motor_maximum_velocity = pending_motion_profile.maximum_velocity;
+	motor_acceleration = pending_motion_profile.acceleration;
+	motor_deceleration = pending_motion_profile.deceleration;
+	motor_acceleration_jerk = pending_motion_profile.acceleration_jerk;
+	motor_deceleration_jerk = pending_motion_profile.deceleration_jerk;
+	motor_cruise_braking_distance = pending_cruise_braking_distance;
+	motion_profile_is_pending = false;
+}
+
+
+bool set_motion_profile(MotionProfile *profile)
+{
+	// The minimum velocity must fit the maximum step period
+	if (profile->minimum_velocity < 1000000.0/MOTOR_MAX_STEP_PERIOD) return false;
+	if (profile->maximum_velocity < profile->minimum_velocity) return false;
+	if (profile->acceleration <= 0) return false;
+	// A negative acceleration jerk would drive the acceleration below zero (0 keeps it constant)
+	if (profile->acceleration_jerk < 0) return false;
+	// The braking distance calculation needs both a deceleration and a deceleration jerk
+	if (profile->deceleration == 0 || profile->deceleration_jerk == 0) return false;
+	
+	MotionProfile planned = *profile;
+	
+	// The deceleration parameters are used as negative values, no matter the sign they were given with
+	if (planned.deceleration > 0) planned.deceleration = -planned.deceleration;
+	if (planned.deceleration_jerk > 0) planned.deceleration_jerk = -planned.deceleration_jerk;
+	
+	// Planned here, so the movements don't need to calculate it while cruising
+	float distance = braking_distance(planned.maximum_velocity - planned.minimum_velocity, planned.deceleration, planned.deceleration_jerk);
+	
+	// The pending profile is applied by the start of the prepared movements, which can happen on an interrupt
+	/* Disable low and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm;
+	pending_motion_profile = planned;
+	pending_cruise_braking_distance = (isnan(distance)) ? 0 : (uint32_t)distance;
+	motion_profile_is_pending = true;
+	prepared_moves_are_stale = true;
+	apply_motion_profile();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+
+void get_motion_profile(MotionProfile *profile)
+{
+	if (motion_profile_is_pending)
+	{
+		*profile = pending_motion_profile;
+		return;
+	}
+	
+	profile->minimum_velocity = motor_minimum_velocity;
+	profile->maximum_velocity = motor_maximum_velocity;
+	profile->acceleration = motor_acceleration;
+	profile->deceleration = motor_deceleration;
+	profile->acceleration_jerk = motor_acceleration_jerk;
+	profile->deceleration_jerk = motor_deceleration_jerk;
+}
+
+
+void apply_pending_motion_profile(void)
+{
+	/* Disable low and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm;
+	apply_motion_profile();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+
+static float braking_distance(float velocity, float deceleration, float deceleration_jerk)
 {
 	// First we calculate the time it will take to brake, based on the current parameters
 	// This solution assumes the value for the velocity is positive, the acceleration is negative,
@@ -95,21 +384,36 @@ float calculate_braking_distance()
 	// Performance is quite similar, staying with floats for better precision
 	//set_OUTPUT_1;
 	// First we calculate the root portion: sqrt(pow(a0, 2)-4*j*v0))	
-	float velocity = motor_current_velocity-motor_minimum_velocity;
-	float root = sqrt(pow(motor_deceleration, 2)-(4*motor_deceleration_jerk*velocity));
+	float root = sqrt(pow(deceleration, 2)-(4*deceleration_jerk*velocity));
 
 	// If root is NAN, then the equation has no solution, the velocity can never reach zero
 	if (isnan(root)) return NAN;
 
 	// Now that we know the equation has a solution, the value we want is given by calculation using the negative root
-	float time = (-motor_deceleration-root)/(2*motor_deceleration_jerk);
+	float time = (-deceleration-root)/(2*deceleration_jerk);
 
 	// Then we calculate how many steps we take during that time, using the same exact parameters
-	float distance = time*((velocity) + (motor_deceleration*time/2) + (motor_deceleration_jerk*pow(time, 2)/6));
+	//clr_OUTPUT_1;
+	return time*((velocity) + (deceleration*time/2) + (deceleration_jerk*pow(time, 2)/6));
+}
 
-	motor_current_braking_distance = (uint32_t)distance;
+
+float calculate_braking_distance()
+{
+	// At the maximum velocity the braking distance is the one planned with the motion profile
+	if (current_movement_status == MOVEMENT_STATUS_CONSTANT_VELOCITY && motor_is_at_maximum_velocity)
+	{
+		motor_current_braking_distance = motor_cruise_braking_distance;
+		return motor_cruise_braking_distance;
+	}
 	
-	//clr_OUTPUT_1;
+	// Above 100 % of feed override, the deceleration runs in real time from the real velocity
+	float velocity = motor_current_velocity*feed_override_overdrive()-motor_minimum_velocity;
+	float distance = braking_distance(velocity, motor_deceleration, motor_deceleration_jerk);
+	
+	if (isnan(distance)) return NAN;
+	
+	motor_current_braking_distance = (uint32_t)distance;
 	return distance;
 }
 
@@ -145,55 +449,193 @@ void set_motor_step_period(int32_t period)
 	/* Disable medium and high level interrupts */
 	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
 	motor_current_step_period = period;
+	motor_ramp_length = 0;
 	/* Re-enable all interrupt levels */
 	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
 }
 
 
-void move_to_target_position(int32_t target_position)
-{	
-	// Need to get the current motor position safely, since this can be called while the motor is moving
-	/* Disable medium and high level interrupts */
-	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
-	int32_t current_position = motor_current_position;
+// Step periods of the first steps from rest, planned with the motion profile the next movement starts with
+// The acceleration is taken as constant (v^2 = vmin^2 + 2*a*steps), the planner adds the jerk once it takes over
+static void plan_ramp_periods(uint16_t *periods)
+{
+	MotionProfile profile;
+	get_motion_profile(&profile);
+	
+	// Above 100 %, the real acceleration and velocity stay within the motion profile (see feed_override_overdrive)
+	float overdrive = (feed_override > 1.0) ? feed_override : 1.0;
+	float acceleration = profile.acceleration/(overdrive*overdrive);
+	float maximum_velocity = profile.maximum_velocity/overdrive;
+	float minimum_velocity_squared = (float)profile.minimum_velocity*profile.minimum_velocity;
+	
+	for (uint8_t i = 0; i < PREPARED_MOVE_RAMP_STEPS; i++)
+	{
+		float velocity = sqrt(minimum_velocity_squared + 2*acceleration*i);
+		if (velocity > maximum_velocity) velocity = maximum_velocity;
+		periods[i] = scaled_step_period(velocity);
+	}
+}
+
+
+void prepare_move(PreparedMove *move, int32_t target_position)
+{
+	// The planning is done on a copy, so the interrupts only wait for the movement to be copied
+	PreparedMove planned;
+	planned.target_position = target_position;
+	plan_ramp_periods(planned.ramp_periods);
+	planned.is_ready = true;
+	
+	// The prepared movements are started by the trigger, the scheduled start and the binary link interrupts
+	/* Disable low and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm;
+	*move = planned;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+
+bool prepared_moves_need_planning(void)
+{
+	if (prepared_moves_are_stale == false) return false;
+	
+	prepared_moves_are_stale = false;
+	return true;
+}
+
+
+void replan_move(PreparedMove *move)
+{
+	if (move->is_ready == false) return;
+	
+	uint16_t periods[PREPARED_MOVE_RAMP_STEPS];
+	plan_ramp_periods(periods);
+	
+	/* Disable low and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm;
+	for (uint8_t i = 0; i < PREPARED_MOVE_RAMP_STEPS; i++)
+		move->ramp_periods[i] = periods[i];
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+
+static bool start_prepared_move_now(PreparedMove *move)
+{
+	if (motor_is_running || move->is_ready == false) return false;
+	
+	// If we are already at the target position, no need to do anything
+	if (move->target_position == motor_current_position) return false;
+	
+	jog_is_active = false;
+	position_limit_events = 0;
+	move->target_position = clamp_to_position_limits(move->target_position);
+	if (move->target_position == motor_current_position) return false;
+	motor_target_position = move->target_position;
+	motor_has_target = true;
+	(motor_target_position > motor_current_position) ? (set_MOTOR_DIRECTION) : (clr_MOTOR_DIRECTION);
+	
+	// The ramp was planned with the queued motion profile, if any, so it is applied now (only copies)
+	apply_motion_profile();
+	
+	// Initialize all the relevant variables with the initial movement settings
+	motor_current_velocity = motor_minimum_velocity;
+	motor_current_acceleration = motor_acceleration;
+	motor_current_jerk = motor_acceleration_jerk;
+	current_movement_status = MOVEMENT_STATUS_ACCELERATING;
+	
+	// The step interrupt plays the ramp, which is kept short enough to never run into the deceleration
+	uint32_t distance = (motor_target_position > motor_current_position) ? motor_target_position - motor_current_position : motor_current_position - motor_target_position;
+	for (uint8_t i = 0; i < PREPARED_MOVE_RAMP_STEPS; i++)
+		motor_ramp_periods[i] = move->ramp_periods[i];
+	motor_ramp_length = (distance/4 < PREPARED_MOVE_RAMP_STEPS) ? distance/4 : PREPARED_MOVE_RAMP_STEPS;
+	motor_ramp_index = 1;
+	// The period for the initial step corresponds to the minimum velocity
+	motor_current_step_period = motor_ramp_periods[0];
+	
+	// Start the timer with the current step period
+	timer_type0_pwm(&TCC0, TIMER_PRESCALER_DIV64, (motor_current_step_period >> 1)-1, motor_current_step_period >> 2, INT_LEVEL_MED, INT_LEVEL_MED);
+	motor_is_running = true;
+	trace_on_move_start();
+	start_move_report();
+	
+	return true;
+}
+
+bool start_prepared_move(PreparedMove *move)
+{
+	// A start from the main loop or the binary link interrupt can't be interrupted by a start from another interrupt
+	/* Disable low and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_MEDLVLEN_bm;
+	bool started = start_prepared_move_now(move);
 	/* Re-enable all interrupt levels */
 	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return started;
+}
+
+
+// Movement used when a new target is requested while the motor is stopped
+PreparedMove immediate_move;
+
+bool move_to_target_position(int32_t target_position)
+{	
+	// Homing and quick stops can't be redirected, same as with set_jog_velocity
+	if (motor_is_running && (current_movement_status == MOVEMENT_STATUS_HOMING || current_movement_status == MOVEMENT_STATUS_STOPPING)) return false;
+	
+	// A target position takes over the jog mode
+	jog_is_active = false;
+	position_limit_events = 0;
+	target_position = clamp_to_position_limits(target_position);
+	
+	// Need to get the current motor position safely, since this can be called while the motor is moving
+	int32_t current_position = get_motor_position();
 		
 	// If we are already at the target position, no need to do anything
-	if (target_position == current_position) return;		
+	if (target_position == current_position) return false;		
 
-	// If we do need to move, first we need to set which direction to go
+	// If the motor is currently not running, plan the movement from rest and start the timer
+	if (motor_is_running == false)	
+	{
+		prepare_move(&immediate_move, target_position);
+		return start_prepared_move(&immediate_move);
+	}
+
+	// Nothing changes if the motor is already going to the same target
+	if (motor_has_target && target_position == motor_target_position) return true;
+
+	// If the motor is running, we need to set which direction to go
 	// @TODO: In the future this could contemplate a change of direction mid-movement (with deceleration)
 	// The current code instantly inverts the movement using its current velocity
-	(motor_target_position > current_position) ? (set_MOTOR_DIRECTION) : (clr_MOTOR_DIRECTION);
+	(target_position > current_position) ? (set_MOTOR_DIRECTION) : (clr_MOTOR_DIRECTION);
 
-	// If the motor is currently not running, we need to reset the movement variables to the default and start the timer
-	if (motor_is_running == false)	
+	// Update the motor_target_position variable that is used in the interrupts to check if the motor arrived to the destination 
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	// Coming from velocity control, the movement continues from the current velocity with the target planner
+	if (current_movement_status == MOVEMENT_STATUS_VELOCITY_CONTROL)
 	{
-		// Initialize all the relevant variables with the initial movement settings
-		motor_current_velocity = motor_minimum_velocity;
+		// The planner works on the velocity before the feed override is applied
+		motor_current_velocity /= feed_override;
 		motor_current_acceleration = motor_acceleration;
-		motor_current_jerk = motor_acceleration_jerk;		
+		motor_current_jerk = motor_acceleration_jerk;
 		current_movement_status = MOVEMENT_STATUS_ACCELERATING;
-		
-		// Set the period for the initial step, which should correspond to the minimum velocity
-		motor_current_step_period = (uint16_t)(1000000/motor_current_velocity);
-	
-		// Start the timer with the current step period
-		timer_type0_pwm(&TCC0, TIMER_PRESCALER_DIV64, (motor_current_step_period >> 1)-1, motor_current_step_period >> 2, INT_LEVEL_MED, INT_LEVEL_MED);
-		motor_is_running = true;
 	}
-	// No matter if the motor is already running or not, we need to update the motor_target_position variable
-	// that is used in the interrupts to check if the motor arrived to the destination 
-	/* Disable medium and high level interrupts */
-	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	// The movement towards the previous target ends here, and a new one is reported from now on
+	end_move_report(REG_MOVE_TO_EVENTS_B_RETARGETED);
 	motor_target_position = target_position;
+	motor_has_target = true;
 	/* Re-enable all interrupt levels */
 	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;	
+	
+	start_move_report();
+	return true;
 }
 
 void move_to_home(int32_t homing_distance)
 {
+	jog_is_active = false;
+	apply_pending_motion_profile();
+	
 	// Let's set the current position to 0 and the target position as the homing distance so we can start the movement
 	// Once the homing is finished, the position will reset to 0 again when the endstop is triggered
 	motor_current_position = 0;	
@@ -211,6 +653,7 @@ void move_to_home(int32_t homing_distance)
 	// Set the period for the initial step, which should correspond to the minimum velocity
 	motor_current_step_period = (uint16_t)(1000000/motor_current_velocity);
 	motor_is_running = true;
+	trace_on_move_start();
 		
 	// Start the timer with the current step period
 	timer_type0_pwm(&TCC0, TIMER_PRESCALER_DIV64, (motor_current_step_period >> 1)-1, motor_current_step_period >> 2, INT_LEVEL_MED, INT_LEVEL_MED);
@@ -221,17 +664,337 @@ void stop_motor(void)
 {
 	timer_type0_stop(&TCC0);
 	motor_is_running = false;
+	motor_ramp_length = 0;
 	
 	motor_current_velocity = 0;
 	motor_current_acceleration = 0;
 	motor_current_jerk = 0;	
 	
 	set_MOTOR_PULSE;
+	trace_on_move_end();
+	
+	if (motor_current_position == motor_target_position)
+	{
+		end_move_report(REG_MOVE_TO_EVENTS_B_TARGET_REACHED);
+	}
+	else
+	{
+		// The stop switch input is low while it is active
+		end_move_report((read_STOP_SWITCH) ? REG_MOVE_TO_EVENTS_B_STOPPED : REG_MOVE_TO_EVENTS_B_STOP_SWITCH);
+	}
 	// Send the stop notification event from the main loop, since this code runs on an interrupt
 	send_motor_stopped_notification = true;
 }
 
 
+void quick_stop_motor(void)
+{
+	motor_quick_stop_requested = true;
+}
+
+
+void start_requested_quick_stop(void)
+{
+	if (motor_quick_stop_requested == false) return;
+	motor_quick_stop_requested = false;
+	jog_is_active = false;
+	
+	if (motor_is_running == false) return;
+	
+	// Homing and slow movements are already at a velocity the motor can stop from without losing steps
+	if (current_movement_status == MOVEMENT_STATUS_HOMING || motor_current_velocity <= motor_minimum_velocity)
+	{
+		stop_motor();
+		current_movement_status = MOVEMENT_STATUS_STOPPED;
+		return;
+	}
+	
+	// The quick stop is not scaled by the feed override, so it starts from the real velocity and acceleration
+	if (current_movement_status != MOVEMENT_STATUS_VELOCITY_CONTROL)
+	{
+		motor_current_velocity *= feed_override;
+		// Above 100 % the acceleration is already in real time
+		if (feed_override < 1.0) motor_current_acceleration *= feed_override*feed_override;
+	}
+	
+	// The deceleration ramps in from the current acceleration, which is kept as the starting point
+	current_movement_status = MOVEMENT_STATUS_STOPPING;
+}
+
+
+void run_motor_at_velocity(float velocity)
+{
+	bool positive = (velocity >= 0);
+	float speed = (positive) ? velocity : -velocity;
+	
+	// Velocities below the one given by the maximum step period can't be generated, so the motor holds still
+	if (speed < 1000000.0/MOTOR_MAX_STEP_PERIOD)
+	{
+		if (motor_is_running) stop_motor();
+		current_movement_status = MOVEMENT_STATUS_STOPPED;
+		return;
+	}
+	if (speed > motor_maximum_velocity) speed = motor_maximum_velocity;
+	
+	uint16_t period = (uint16_t)(1000000/speed);
+	if (period < MOTOR_MIN_STEP_PERIOD) period = MOTOR_MIN_STEP_PERIOD;
+	
+	// Direction and step period must change together, so the interrupt counts the next step in the right direction
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	// Leaving the target position behind ends the movement that was going to it
+	end_move_report(REG_MOVE_TO_EVENTS_B_RETARGETED);
+	motor_has_target = false;
+	motor_direction_is_positive = positive;
+	update_steps_until_limit();
+	
+	// The motor can't move any further towards a position limit it already reached
+	if (motor_steps_until_limit <= 0)
+	{
+		if (motor_is_running) stop_motor();
+		current_movement_status = MOVEMENT_STATUS_STOPPED;
+		if (position_limit_events == 0) report_position_limit(positive);
+		/* Re-enable all interrupt levels */
+		PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+		return;
+	}
+	
+	(positive) ? (set_MOTOR_DIRECTION) : (clr_MOTOR_DIRECTION);
+	motor_current_step_period = period;
+	motor_ramp_length = 0;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	motor_current_velocity = speed;
+	motor_current_acceleration = 0;
+	motor_current_jerk = 0;
+	current_movement_status = MOVEMENT_STATUS_VELOCITY_CONTROL;
+	
+	// Start the timer if the motor was stopped
+	if (motor_is_running == false)
+	{
+		timer_type0_pwm(&TCC0, TIMER_PRESCALER_DIV64, (period >> 1)-1, period >> 2, INT_LEVEL_MED, INT_LEVEL_MED);
+		motor_is_running = true;
+		trace_on_move_start();
+	}
+}
+
+
+bool set_jog_velocity(int32_t velocity)
+{
+	// Homing and quick stops can't be interrupted, but a movement to a target can be taken over
+	if (motor_is_running && (current_movement_status == MOVEMENT_STATUS_HOMING || current_movement_status == MOVEMENT_STATUS_STOPPING)) return false;
+	
+	if (velocity > (int32_t)motor_maximum_velocity) velocity = motor_maximum_velocity;
+	if (velocity < -(int32_t)motor_maximum_velocity) velocity = -(int32_t)motor_maximum_velocity;
+	
+	jog_target_velocity = velocity;
+	position_limit_events = 0;
+	
+	if (jog_is_active == false)
+	{
+		// Nothing to do if the motor is already stopped
+		if (velocity == 0 && motor_is_running == false) return true;
+		
+		// The ramp starts from the velocity the motor has right now
+		jog_velocity = (float)get_motor_velocity();
+		jog_acceleration = 0;
+		
+		// Set the flag last, since the ramp may be updated by the main loop as soon as it is set
+		jog_is_active = true;
+	}
+	
+	return true;
+}
+
+
+extern AppRegs app_regs;
+
+void update_jog_velocity(void)
+{
+	if (jog_is_active == false) return;
+	
+	// Leave the jog mode if the motor was disabled or the stop switch was hit
+	if (!read_STOP_SWITCH || !(app_regs.REG_CONTROL & REG_CONTROL_B_ENABLE_MOTOR))
+	{
+		jog_is_active = false;
+		return;
+	}
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	float target = (float)jog_target_velocity;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	float error = target - jog_velocity;
+	
+	// Going away from zero uses the acceleration settings, going towards zero uses the deceleration settings
+	bool speeding_up = (jog_velocity == 0) || (((target >= 0) == (jog_velocity >= 0)) && (fabs(target) > fabs(jog_velocity)));
+	float maximum_acceleration = (speeding_up) ? motor_acceleration : -motor_deceleration;
+	float jerk = (speeding_up) ? motor_acceleration_jerk : -motor_deceleration_jerk;
+	
+	if (jerk > 0)
+	{
+		// Highest acceleration that still allows ramping it out at the jerk limit by the time the target is reached
+		float desired_acceleration = sqrt(2*jerk*fabs(error));
+		if (desired_acceleration > maximum_acceleration) desired_acceleration = maximum_acceleration;
+		if (error < 0) desired_acceleration = -desired_acceleration;
+		
+		float step = jerk*JOG_UPDATE_PERIOD;
+		if (jog_acceleration < desired_acceleration - step) jog_acceleration += step;
+		else if (jog_acceleration > desired_acceleration + step) jog_acceleration -= step;
+		else jog_acceleration = desired_acceleration;
+	}
+	else
+	{
+		jog_acceleration = (error < 0) ? -maximum_acceleration : maximum_acceleration;
+	}
+	
+	float velocity = jog_velocity + jog_acceleration*JOG_UPDATE_PERIOD;
+	
+	// Land exactly on the target instead of going around it
+	if ((error >= 0 && velocity >= target) || (error <= 0 && velocity <= target))
+	{
+		velocity = target;
+		jog_acceleration = 0;
+	}
+	
+	jog_velocity = velocity;
+	run_motor_at_velocity(velocity);
+	
+	// The jog mode ends once the motor ramped down to a stop
+	if (velocity == 0 && target == 0) jog_is_active = false;
+}
+
+
+bool set_feed_override(uint8_t percent)
+{
+	if (percent < 1 || percent > 200) return false;
+	
+	feed_override_target = percent/100.0;
+	return true;
+}
+
+
+void update_feed_override(void)
+{
+	if (feed_override == feed_override_target) return;
+	
+	// Changing the time scale changes the velocity, so the change is spread to keep it within the acceleration settings
+	float velocity = (motor_current_velocity > motor_minimum_velocity) ? motor_current_velocity : motor_minimum_velocity;
+	float acceleration = (feed_override_target > feed_override) ? motor_acceleration : -motor_deceleration;
+	float max_change = acceleration*0.0005/velocity;
+	
+	if (feed_override_target > feed_override + max_change) feed_override += max_change;
+	else if (feed_override_target < feed_override - max_change) feed_override -= max_change;
+	else feed_override = feed_override_target;
+	
+	// Planned once the ramp ends, the starts in between use the ramps of the previous feed override
+	if (feed_override == feed_override_target) prepared_moves_are_stale = true;
+}
+
+
+bool set_position_limits(int32_t minimum, int32_t maximum)
+{
+	if (minimum >= maximum) return false;
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	position_limit_minimum = minimum;
+	position_limit_maximum = maximum;
+	update_steps_until_limit();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+
+void enable_position_limits(bool enable)
+{
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	position_limits_enabled = enable;
+	update_steps_until_limit();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+
+void check_position_limits(void)
+{
+	// Movements to a target were already clamped, so only velocity control can run into a limit
+	if (position_limits_enabled == false || motor_is_running == false || current_movement_status != MOVEMENT_STATUS_VELOCITY_CONTROL) return;
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	int32_t distance = motor_steps_until_limit;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	// Distance needed by the quick stop, including the time the deceleration takes to ramp in
+	float velocity = motor_current_velocity;
+	float braking_distance = velocity*velocity/(-2*motor_quick_stop_deceleration) + velocity*motor_quick_stop_deceleration/motor_quick_stop_jerk;
+	
+	if (distance <= braking_distance)
+	{
+		report_position_limit(motor_direction_is_positive);
+		quick_stop_motor();
+	}
+}
+
+
+bool position_is_within_limits(int32_t position)
+{
+	if (position_limits_enabled == false) return true;
+	
+	return (position >= position_limit_minimum && position <= position_limit_maximum);
+}
+
+
+int32_t get_motor_position(void)
+{
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	int32_t position = motor_current_position;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return position;
+}
+
+
+void set_motor_position(int32_t position)
+{
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	// Shift the target by the same offset so an ongoing movement still ends at the same physical place
+	motor_target_position += position - motor_current_position;
+	motor_current_position = position;
+	update_steps_until_limit();
+	position_compare_sync();
+	waypoints_sync();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+
+int32_t get_motor_velocity(void)
+{
+	if (motor_is_running == false) return 0;
+	
+	float speed = motor_current_velocity;
+	
+	// The target planner works on the velocity before the feed override is applied
+	if (motor_has_target && current_movement_status != MOVEMENT_STATUS_HOMING && current_movement_status != MOVEMENT_STATUS_STOPPING) speed *= feed_override;
+	
+	// The direction pin is cleared (set_MOTOR_DIRECTION) when moving towards positive positions
+	int32_t velocity = (int32_t)speed;
+	return (read_MOTOR_DIRECTION) ? -velocity : velocity;
+}
+
+
 void update_motor_velocity()
 {	
 	//set_OUTPUT_0;
@@ -258,12 +1021,31 @@ void update_motor_velocity()
 		// If the estimated breaking distance is bigger than the remaining distance, we need to slow down a little harder to compensate
 		if (motor_current_braking_distance > remaining_distance)
 		{			
-			set_OUTPUT_1;	
 			// Calculate a tweaking factor to be applied to the velocity. 
 			// This factor needs to have a stronger effect the slower velocity in order to work properly
 			float tweak = 1.0 - pow((motor_minimum_velocity/motor_current_velocity),2)/8;
 			motor_current_velocity *= tweak;
-			clr_OUTPUT_1;	
+		}
+	}
+	// While quick stopping, the deceleration ramps in up to its maximum and ramps out just as the minimum velocity is reached
+	// This is the shortest stop possible with the quick stop deceleration and jerk
+	else if (current_movement_status == MOVEMENT_STATUS_STOPPING)
+	{
+		// Velocity that is still lost while the deceleration ramps out to zero
+		float ramp_out_velocity = pow(motor_current_acceleration, 2)/(-2*motor_quick_stop_jerk);
+		
+		if (motor_current_acceleration < 0 && (motor_current_velocity - motor_minimum_velocity) <= ramp_out_velocity)
+		{
+			motor_current_jerk = -motor_quick_stop_jerk;
+		}
+		else if (motor_current_acceleration > motor_quick_stop_deceleration)
+		{
+			motor_current_jerk = motor_quick_stop_jerk;
+		}
+		else
+		{
+			motor_current_jerk = 0;
+			motor_current_acceleration = motor_quick_stop_deceleration;
 		}
 	}
 	
@@ -315,27 +1097,52 @@ void update_motor_velocity()
 	// 20 us (added the maximum velocity constrain)
 	//set_OUTPUT_1;
 	// We assume the function is called every 500us, so the time delta is 0.0005s
-	float delta = 0.0005;
+	// The feed override scales the time of the movement, so the path and the final position don't change
+	float time_scale = (current_movement_status == MOVEMENT_STATUS_STOPPING) ? 1.0 : feed_override;
+	// Above 100 %, only the velocity is scaled, so the real acceleration and jerk never go over the motion profile
+	float overdrive = feed_override_overdrive();
+	float delta = 0.0005*time_scale/overdrive;
 	// Calculate the new acceleration and velocity based on the time elapsed
 	motor_current_acceleration += motor_current_jerk*delta;
-	motor_current_velocity += motor_current_acceleration*delta;
+	motor_current_velocity += motor_current_acceleration*delta/overdrive;
+	
+	if (current_movement_status == MOVEMENT_STATUS_STOPPING)
+	{
+		// Don't go over the quick stop deceleration while it ramps in
+		if (motor_current_acceleration < motor_quick_stop_deceleration) motor_current_acceleration = motor_quick_stop_deceleration;
+		
+		// The motor can stop right away once the minimum velocity is reached
+		if (motor_current_velocity <= motor_minimum_velocity)
+		{
+			stop_motor();
+			current_movement_status = MOVEMENT_STATUS_STOPPED;
+			return;
+		}
+	}
 	
 	// If we just exceeded maximum velocity, it means we were accelerating just now, 
 	// so we need to stop the acceleration and set the velocity to the limit
-	if (motor_current_velocity > motor_maximum_velocity)
+	// The limit is lowered by the feed override above 100 %, so the real velocity stays at the maximum velocity
+	motor_is_at_maximum_velocity = (motor_current_velocity > motor_maximum_velocity/overdrive);
+	if (motor_is_at_maximum_velocity)
 	{
-		motor_current_velocity = motor_maximum_velocity;
+		motor_current_velocity = motor_maximum_velocity/overdrive;
 		current_movement_status = MOVEMENT_STATUS_CONSTANT_VELOCITY;
 	}	
+	
+	// Keep track of the highest velocity of the movement for its report
+	if (motor_current_velocity*time_scale > move_peak_velocity) move_peak_velocity = motor_current_velocity*time_scale;
 	// Update the motor step period to match the final velocity
-	uint32_t new_step_period = (uint32_t)(1000000/motor_current_velocity);
+	uint32_t new_step_period = (time_scale == 1.0) ? (uint32_t)(1000000/motor_current_velocity) : scaled_step_period(motor_current_velocity);
 	//clr_OUTPUT_1;
 
 
 	// Now we update the motor_current_step_period variable which is used by the interrupt to update the timers
 	/* Disable medium and high level interrupts */
 	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
-	motor_current_step_period = new_step_period;	
+	// The first steps are timed by the ramp of the prepared movement, as long as the motor is still accelerating
+	if (current_movement_status != MOVEMENT_STATUS_ACCELERATING) motor_ramp_length = 0;
+	if (motor_ramp_index >= motor_ramp_length) motor_current_step_period = new_step_period;
 	/* Re-enable all interrupt levels */
 	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
 }
@@ -349,11 +1156,52 @@ ISR(TCC0_OVF_vect/*, ISR_NAKED*/)
 }
 
 
+extern bool trace_is_running;
+extern bool compare_is_enabled;
+extern bool waypoints_are_enabled;
+
 ISR(TCC0_CCA_vect/*, ISR_NAKED*/)
 {
+	// The stop switch already cut the pulses in hardware, so this step never reached the driver
+	if (emergency_stop_is_active())
+	{
+		stop_motor();
+		return;
+	}
+	
+	// While under velocity control there is no target, so the steps are counted in the commanded direction
+	if (motor_has_target == false)
+	{
+		(motor_direction_is_positive) ? motor_current_position++ : motor_current_position--;
+		if (trace_is_running) trace_record_step(motor_current_step_period);
+		if (compare_is_enabled) position_compare_on_step(motor_current_position);
+		if (waypoints_are_enabled) waypoints_on_step(motor_current_position);
+		
+		// Never go past a position limit, even if the main loop could not decelerate in time
+		if (position_limits_enabled && --motor_steps_until_limit <= 0)
+		{
+			stop_motor();
+			current_movement_status = MOVEMENT_STATUS_STOPPED;
+			report_position_limit(motor_direction_is_positive);
+		}
+		return;
+	}
+
 	// Update the motor position depending on the direction the motor is spinning
 	(motor_current_position < motor_target_position) ? motor_current_position++ : motor_current_position--;
 
+	// The next step of the planned ramp, loaded on the timer at the end of this period
+	if (motor_ramp_index < motor_ramp_length) motor_current_step_period = motor_ramp_periods[motor_ramp_index++];
+
+	// Record the step on the trace buffer
+	if (trace_is_running) trace_record_step(motor_current_step_period);
+	
+	// Pulse the outputs at their trigger positions
+	if (compare_is_enabled) position_compare_on_step(motor_current_position);
+	
+	// Report the waypoints reached with the time of the step
+	if (waypoints_are_enabled) waypoints_on_step(motor_current_position);
+
 	// The target position was reached, we can stop the motor now
 	if (motor_current_position == motor_target_position)
 	{
@@ -12,14 +12,73 @@
 #endif
 
 // Enumeration to specify the status of the current movement
-enum MovementStatus {MOVEMENT_STATUS_STOPPED, MOVEMENT_STATUS_ACCELERATING, MOVEMENT_STATUS_DECELERATING, MOVEMENT_STATUS_CONSTANT_VELOCITY, MOVEMENT_STATUS_HOMING};
+enum MovementStatus {MOVEMENT_STATUS_STOPPED, MOVEMENT_STATUS_ACCELERATING, MOVEMENT_STATUS_DECELERATING, MOVEMENT_STATUS_CONSTANT_VELOCITY, MOVEMENT_STATUS_HOMING, MOVEMENT_STATUS_VELOCITY_CONTROL, MOVEMENT_STATUS_STOPPING};
 
+// Number of steps at the start of a prepared movement that are timed by its planned ramp
+// The step interrupt plays them, so the acceleration starts on the first step instead of on the next velocity update (500 us)
+#define PREPARED_MOVE_RAMP_STEPS 8
+
+// Initial state of a movement from rest, planned ahead so it can be started with minimal latency
+// The ramp is planned again on the main loop when the motion profile or the feed override change, so the start only loads it
+typedef struct
+{
+	int32_t target_position;
+	uint16_t ramp_periods[PREPARED_MOVE_RAMP_STEPS];
+	bool is_ready;
+} PreparedMove;
+
+
+// Statistics of a movement to a target position, captured when it ended
+typedef struct
+{
+	uint8_t reason;
+	uint32_t second;
+	uint32_t microsecond;
+	int32_t duration;
+	int32_t peak_velocity;
+	int32_t position_error;
+} MoveReport;
+
+
+// Complete set of motion parameters, applied all at once when the motor is stopped
+typedef struct
+{
+	uint16_t minimum_velocity;
+	uint16_t maximum_velocity;
+	float acceleration;
+	float deceleration;
+	float acceleration_jerk;
+	float deceleration_jerk;
+} MotionProfile;
+
+
+// Validate a motion profile and queue it to be applied at the next movement boundary
+bool set_motion_profile(MotionProfile *profile);
+
+// Get the motion profile the next movement will use (the queued one, if any)
+void get_motion_profile(MotionProfile *profile);
+
+// Apply the queued motion profile if the motor is stopped
+void apply_pending_motion_profile(void);
 
 // Move the motor with a specific fixed interval between each step
 void set_motor_step_period(int32_t period);
 
-// Move the motor to a specific position
-void move_to_target_position(int32_t target_position);
+// Move the motor to a specific position, returns false if no movement was started or redirected
+// (already at the target, or the motor is homing or doing a quick stop)
+bool move_to_target_position(int32_t target_position);
+
+// Plan a movement from rest to a specific position, to be started later with start_prepared_move
+void prepare_move(PreparedMove *move, int32_t target_position);
+
+// Start a prepared movement if the motor is stopped (safe to call from an interrupt)
+bool start_prepared_move(PreparedMove *move);
+
+// Returns true once after the motion profile or the feed override changed, when the prepared movements need to be planned again
+bool prepared_moves_need_planning(void);
+
+// Plan the ramp of a prepared movement again with the current settings, keeping its target (called from the main loop)
+void replan_move(PreparedMove *move);
 
 // Move the motor to the home position (where the endstop switch activates)
 void move_to_home(int32_t homing_distance);
@@ -33,5 +92,53 @@ void update_motor_velocity();
 // Immediately stop the motor 
 void stop_motor();
 
+// Request a jerk-limited stop using the quick stop deceleration (safe to call from an interrupt)
+void quick_stop_motor(void);
+
+// Start the requested quick stop, called from the main loop before updating the velocity
+void start_requested_quick_stop(void);
+
+// Run the motor continuously at a signed velocity (steps/s) while keeping track of the position
+// The velocity is applied immediately, so callers are responsible for limiting its rate of change
+void run_motor_at_velocity(float velocity);
+
+// Ramp the motor towards a signed velocity (steps/s) using the acceleration and jerk settings
+// Can be called again at any time to change the target without restarting the ramp (safe to call from an interrupt)
+bool set_jog_velocity(int32_t velocity);
+
+// Update the jog velocity ramp, called from the main loop every 500 us
+void update_jog_velocity(void);
+
+// Set the feed override (percent), which scales the time of the movements to a target and of the streamed setpoints
+// Above 100 %, movements to a target are still limited to the maximum velocity, acceleration and jerk
+bool set_feed_override(uint8_t percent);
+
+// Ramp the feed override towards the requested value, called from the main loop every 500 us
+void update_feed_override(void);
+
+// Set the software position limits (steps), which are only enforced while enabled
+bool set_position_limits(int32_t minimum, int32_t maximum);
+
+// Enable or disable the software position limits
+void enable_position_limits(bool enable);
+
+// Start a controlled deceleration if the motor is about to reach a position limit under velocity control
+void check_position_limits(void);
+
+// Returns true if a target position would not be clamped by the position limits
+bool position_is_within_limits(int32_t position);
+
+// Get the current position of the motor (steps), safe to call while the motor is moving
+int32_t get_motor_position(void);
+
+// Redefine the current position of the motor (steps) without moving it
+void set_motor_position(int32_t position);
+
+// Get the signed velocity currently commanded to the motor (steps/s)
+int32_t get_motor_velocity(void);
+
+// Copy the report of the last movement that ended, returns false if there is no new report
+bool get_move_report(MoveReport *report);
+
 
 #endif /* _STEPPER_MOTOR_H_ */
\ No newline at end of file
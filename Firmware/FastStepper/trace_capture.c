@@ -0,0 +1,158 @@
+#include "trace_capture.h"
+#include "app_ios_and_regs.h"
+#include "encoder.h"
+
+extern AppRegs app_regs;
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Signals to record on each sample (REG_TRACE_SIGNALS bitmask)
+uint8_t trace_signals = REG_TRACE_SIGNALS_B_STEP_TIME | REG_TRACE_SIGNALS_B_STEP_PERIOD;
+
+// Record one sample every trace_decimation steps
+uint8_t trace_decimation = 1;
+
+// Flag indicating the capture will start with the next movement
+bool trace_is_armed = false;
+
+// Flag indicating the step interrupt is recording samples
+bool trace_is_running = false;
+
+// Flag indicating a capture has finished and can be read
+bool trace_is_done = false;
+
+// Flag used by the interrupts to indicate the capture finished and an event should be sent
+bool send_trace_done_notification = false;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Ring buffer where the samples are stored
+uint16_t trace_buffer[TRACE_BUFFER_WORDS];
+
+// Usable size of the buffer, always a multiple of the number of words per sample
+uint16_t trace_capacity = TRACE_BUFFER_WORDS;
+
+// Index where the next word will be written
+uint16_t trace_head = 0;
+
+// Flag indicating the oldest samples were overwritten
+bool trace_wrapped = false;
+
+// Time elapsed since the capture started (in us)
+uint32_t trace_elapsed_time = 0;
+
+// Steps since the last recorded sample
+uint8_t trace_decimation_counter = 0;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+void trace_start(void)
+{
+	// Count the number of words each sample takes so a sample never wraps around the end of the buffer
+	uint8_t words_per_sample = 0;
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		if (trace_signals & (1 << i)) words_per_sample++;
+	}
+	if (words_per_sample == 0) return;
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	trace_capacity = (TRACE_BUFFER_WORDS / words_per_sample) * words_per_sample;
+	trace_head = 0;
+	trace_wrapped = false;
+	trace_elapsed_time = 0;
+	trace_decimation_counter = 0;
+	trace_is_armed = false;
+	trace_is_done = false;
+	trace_is_running = true;
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+void trace_arm(void)
+{
+	trace_is_running = false;
+	trace_is_done = false;
+	trace_is_armed = true;
+}
+
+void trace_stop(void)
+{
+	trace_is_armed = false;
+	
+	if (trace_is_running)
+	{
+		trace_is_running = false;
+		trace_is_done = true;
+		send_trace_done_notification = true;
+	}
+}
+
+void trace_on_move_start(void)
+{
+	if (trace_is_armed) trace_start();
+}
+
+void trace_on_move_end(void)
+{
+	if (trace_is_running) trace_stop();
+}
+
+void trace_record_step(uint16_t step_period)
+{
+	// The timer runs with a 2 us resolution, so the real period is always even
+	step_period &= ~1;
+	
+	if (++trace_decimation_counter >= trace_decimation)
+	{
+		trace_decimation_counter = 0;
+		
+		if (trace_signals & REG_TRACE_SIGNALS_B_STEP_TIME)   trace_buffer[trace_head++] = (uint16_t)trace_elapsed_time;
+		if (trace_signals & REG_TRACE_SIGNALS_B_STEP_PERIOD) trace_buffer[trace_head++] = step_period;
+		if (trace_signals & REG_TRACE_SIGNALS_B_ENCODER)     trace_buffer[trace_head++] = (uint16_t)get_quadrature_encoder();
+		if (trace_signals & REG_TRACE_SIGNALS_B_ANALOG)      trace_buffer[trace_head++] = (uint16_t)app_regs.REG_ANALOG_INPUT;
+		
+		if (trace_head >= trace_capacity)
+		{
+			trace_head = 0;
+			trace_wrapped = true;
+		}
+	}
+	
+	trace_elapsed_time += step_period;
+}
+
+uint16_t trace_get_count(void)
+{
+	return (trace_wrapped) ? trace_capacity : trace_head;
+}
+
+void trace_read_block(uint16_t *dest, uint16_t index, uint8_t n)
+{
+	uint16_t count = trace_get_count();
+	// When the buffer wrapped, the oldest word is the next one to be overwritten
+	uint16_t oldest = (trace_wrapped) ? trace_head : 0;
+	
+	for (uint8_t i = 0; i < n; i++, index++)
+	{
+		if (index < count)
+		{
+			uint16_t position = oldest + index;
+			if (position >= trace_capacity) position -= trace_capacity;
+			dest[i] = trace_buffer[position];
+		}
+		else
+		{
+			dest[i] = 0;
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#ifndef _TRACE_CAPTURE_H_
+#define _TRACE_CAPTURE_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Size of the capture ring buffer (in 16-bit words)
+#define TRACE_BUFFER_WORDS 128
+
+// Number of words returned by each read of REG_TRACE_DATA
+#define TRACE_DATA_BLOCK_WORDS 32
+
+// Arm the capture so it starts with the next movement and ends when the motor stops
+void trace_arm(void);
+
+// Start the capture immediately
+void trace_start(void);
+
+// Stop the capture, keeping the captured data
+void trace_stop(void);
+
+// Called when a new movement starts
+void trace_on_move_start(void);
+
+// Called when the motor stops
+void trace_on_move_end(void);
+
+// Record the selected signals for the step that just happened (called from the step interrupt)
+void trace_record_step(uint16_t step_period);
+
+// Number of valid words in the buffer
+uint16_t trace_get_count(void);
+
+// Copy n words starting at index (0 is the oldest word) to dest, zero filling past the end
+void trace_read_block(uint16_t *dest, uint16_t index, uint8_t n);
+
+#endif /* _TRACE_CAPTURE_H_ */
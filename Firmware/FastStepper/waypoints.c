@@ -0,0 +1,132 @@
+#include "waypoints.h"
+#include "cpu.h"
+#include "move_triggers.h"
+#include "position_neighbours.h"
+
+/************************************************************************/
+/* Global Parameters                                                    */
+/************************************************************************/
+
+// Flag indicating the waypoints are checked, read by the step interrupt
+bool waypoints_are_enabled = false;
+
+// Waypoints (steps, ascending) and how many are used
+int32_t waypoints[WAYPOINTS_SIZE];
+uint8_t waypoints_count = 0;
+
+
+/************************************************************************/
+/* Globals                                                              */
+/************************************************************************/
+
+// Crossing of a waypoint, waiting to be sent by the main loop
+typedef struct
+{
+	uint8_t index;
+	bool is_positive;
+	uint32_t second;
+	uint32_t microsecond;
+} WaypointCrossing;
+
+static bool waypoint_position_of(void *list, int32_t index, int32_t *position);
+
+// Waypoints around the current position
+PositionNeighbours waypoints_around = { .position_of = waypoint_position_of };
+
+// Crossings waiting for the main loop, written by the step interrupt only
+WaypointCrossing waypoints_queue[WAYPOINTS_QUEUE_SIZE];
+volatile uint8_t waypoints_queue_head = 0;
+volatile uint8_t waypoints_queue_tail = 0;
+
+
+/************************************************************************/
+/* Functions                                                            */
+/************************************************************************/
+
+extern bool motor_is_running;
+extern int32_t motor_current_position;
+
+static bool waypoint_position_of(void *list, int32_t index, int32_t *position)
+{
+	if (index < 0 || index >= waypoints_count) return false;
+	
+	*position = waypoints[index];
+	return true;
+}
+
+void waypoints_sync(void)
+{
+	// A waypoint exactly at the current position is not reported, but it is once the motor leaves it and comes back
+	position_neighbours_sync_table(&waypoints_around, waypoints, waypoints_count, motor_current_position);
+}
+
+bool waypoints_set(int32_t *positions, uint8_t count)
+{
+	if (count > WAYPOINTS_SIZE) return false;
+	
+	for (uint8_t i = 1; i < count; i++)
+	{
+		if (positions[i] <= positions[i-1]) return false;
+	}
+	
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	for (uint8_t i = 0; i < count; i++)
+		waypoints[i] = positions[i];
+	waypoints_count = count;
+	waypoints_are_enabled = (count > 0);
+	waypoints_sync();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+	
+	return true;
+}
+
+static void waypoints_push_crossing(int8_t index, bool is_positive)
+{
+	uint8_t next = (waypoints_queue_head + 1) % WAYPOINTS_QUEUE_SIZE;
+	
+	// The crossing is dropped if the main loop is too far behind
+	if (next == waypoints_queue_tail) return;
+	
+	WaypointCrossing *crossing = &waypoints_queue[waypoints_queue_head];
+	crossing->index = index;
+	crossing->is_positive = is_positive;
+	read_harp_timestamp(&crossing->second, &crossing->microsecond);
+	
+	waypoints_queue_head = next;
+}
+
+void waypoints_on_step(int32_t position)
+{
+	int32_t index;
+	int8_t direction = position_neighbours_on_step(&waypoints_around, position, &index);
+	
+	if (direction != 0) waypoints_push_crossing(index, direction > 0);
+}
+
+void waypoints_update(void)
+{
+	if (waypoints_are_enabled == false || motor_is_running) return;
+	
+	// The position may have been redefined while stopped
+	/* Disable medium and high level interrupts */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm;
+	waypoints_sync();
+	/* Re-enable all interrupt levels */
+	PMIC_CTRL = PMIC_RREN_bm | PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm;
+}
+
+bool waypoints_pop_crossing(int32_t *crossing)
+{
+	if (waypoints_queue_tail == waypoints_queue_head) return false;
+	
+	WaypointCrossing *queued = &waypoints_queue[waypoints_queue_tail];
+	crossing[0] = queued->index;
+	crossing[1] = (queued->is_positive) ? 1 : -1;
+	crossing[2] = queued->second;
+	crossing[3] = queued->microsecond;
+	
+	waypoints_queue_tail = (waypoints_queue_tail + 1) % WAYPOINTS_QUEUE_SIZE;
+	return true;
+}
@@ -0,0 +1,35 @@
+#ifndef _WAYPOINTS_H_
+#define _WAYPOINTS_H_
+#include <avr/io.h>
+
+// Define if not defined
+#ifndef bool
+	#define bool uint8_t
+#endif
+#ifndef true
+	#define true 1
+	#define false 0
+#endif
+
+// Maximum number of waypoints
+#define WAYPOINTS_SIZE 8
+
+// Number of crossings that can wait for the main loop
+#define WAYPOINTS_QUEUE_SIZE 4
+
+// Set the waypoints (steps), the first count entries are used and must be strictly ascending (count 0 disables them)
+bool waypoints_set(int32_t *positions, uint8_t count);
+
+// Find the waypoints around the current position again (call with the step interrupt disabled)
+void waypoints_sync(void);
+
+// Queue the waypoint reached by this step, with its timestamp (called from the step interrupt)
+void waypoints_on_step(int32_t position);
+
+// Follow changes of the position while the motor is stopped, called from the main loop every 500 us
+void waypoints_update(void);
+
+// Get the next crossing (index, direction, seconds, microseconds), returns false if there is none
+bool waypoints_pop_crossing(int32_t *crossing);
+
+#endif /* _WAYPOINTS_H_ */
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include "binary_link.h"
+
+/************************************************************************/
+/* Parser state                                                         */
+/************************************************************************/
+extern uint8_t binary_link_index;
+extern uint16_t binary_link_crc_errors;
+extern uint16_t binary_link_line_errors;
+
+static int failures = 0;
+
+#define CHECK(condition) do { if (!(condition)) { printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); failures++; } } while (0)
+
+
+/************************************************************************/
+/* Helpers                                                              */
+/************************************************************************/
+
+static void build_frame(uint8_t *frame, uint8_t command, int32_t argument)
+{
+	frame[0] = BINARY_LINK_SYNC;
+	frame[1] = command;
+	for (uint8_t i = 0; i < 4; i++) frame[2 + i] = (uint8_t)((uint32_t)argument >> (8 * i));
+	
+	uint8_t crc = 0;
+	for (uint8_t i = 1; i < BINARY_LINK_FRAME_SIZE - 1; i++) crc = binary_link_crc8(crc, frame[i]);
+	frame[BINARY_LINK_FRAME_SIZE - 1] = crc;
+}
+
+// Feed bytes to the parser, returns the number of complete frames and keeps the last one
+static int feed(const uint8_t *bytes, int count, BinaryLinkCommand *command)
+{
+	int frames = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (binary_link_parse_byte(bytes[i], command)) frames++;
+	}
+	return frames;
+}
+
+static void reset_state(void)
+{
+	BinaryLinkCommand command;
+	
+	binary_link_reset();
+	binary_link_crc_errors = 0;
+	binary_link_line_errors = 0;
+	while (binary_link_queue_pop(&command));
+}
+
+
+/************************************************************************/
+/* Tests                                                                */
+/************************************************************************/
+
+static void test_crc8(void)
+{
+	// CRC-8 with polynomial 0x07 and initial value 0x00 of "123456789"
+	const char *check = "123456789";
+	uint8_t crc = 0;
+	for (const char *c = check; *c; c++) crc = binary_link_crc8(crc, (uint8_t)*c);
+	CHECK(crc == 0xF4);
+}
+
+static void test_valid_frame(void)
+{
+	uint8_t frame[BINARY_LINK_FRAME_SIZE];
+	BinaryLinkCommand command;
+	
+	reset_state();
+	build_frame(frame, BINARY_LINK_CMD_MOVE_TO, -123456);
+	CHECK(feed(frame, BINARY_LINK_FRAME_SIZE, &command) == 1);
+	CHECK(command.command == BINARY_LINK_CMD_MOVE_TO);
+	CHECK(command.argument == -123456);
+	CHECK(binary_link_crc_errors == 0);
+	CHECK(binary_link_index == 0);
+}
+
+static void test_wrong_crc(void)
+{
+	uint8_t frame[BINARY_LINK_FRAME_SIZE];
+	BinaryLinkCommand command;
+	
+	reset_state();
+	build_frame(frame, BINARY_LINK_CMD_VELOCITY, 1000);
+	frame[3] ^= 0x10;
+	CHECK(feed(frame, BINARY_LINK_FRAME_SIZE, &command) == 0);
+	CHECK(binary_link_crc_errors == 1);
+	
+	// The next frame is received normally
+	build_frame(frame, BINARY_LINK_CMD_VELOCITY, 1000);
+	CHECK(feed(frame, BINARY_LINK_FRAME_SIZE, &command) == 1);
+	CHECK(command.argument == 1000);
+}
+
+static void test_resync(void)
+{
+	uint8_t bytes[3 + 3 + BINARY_LINK_FRAME_SIZE];
+	BinaryLinkCommand command;
+	
+	reset_state();
+	
+	// Noise before the frame is skipped until the sync byte
+	bytes[0] = 0x00;
+	bytes[1] = 0xFF;
+	bytes[2] = 0x12;
+	
+	// A frame cut after three bytes and dropped by the line error
+	bytes[3] = BINARY_LINK_SYNC;
+	bytes[4] = BINARY_LINK_CMD_STOP;
+	bytes[5] = 0x00;
+	CHECK(feed(bytes, 6, &command) == 0);
+	binary_link_drop_frame();
+	CHECK(binary_link_line_errors == 1);
+	
+	// A line error between frames isn't counted
+	binary_link_drop_frame();
+	CHECK(binary_link_line_errors == 1);
+	
+	build_frame(&bytes[6], BINARY_LINK_CMD_PRESET, 2);
+	CHECK(feed(&bytes[6], BINARY_LINK_FRAME_SIZE, &command) == 1);
+	CHECK(command.command == BINARY_LINK_CMD_PRESET);
+	CHECK(command.argument == 2);
+}
+
+static void test_timeout(void)
+{
+	uint8_t frame[BINARY_LINK_FRAME_SIZE];
+	BinaryLinkCommand command;
+	
+	reset_state();
+	build_frame(frame, BINARY_LINK_CMD_MOVE_TO, 500);
+	
+	// A partial frame survives one ms without bytes
+	CHECK(feed(frame, 4, &command) == 0);
+	binary_link_check_timeout();
+	CHECK(binary_link_index == 4);
+	
+	// But not two, so the rest of it is taken as noise
+	binary_link_check_timeout();
+	CHECK(binary_link_index == 0);
+	CHECK(feed(&frame[4], BINARY_LINK_FRAME_SIZE - 4, &command) == 0);
+	
+	// Receiving a byte restarts the timeout
+	CHECK(feed(frame, 3, &command) == 0);
+	binary_link_check_timeout();
+	CHECK(feed(&frame[3], 1, &command) == 0);
+	binary_link_check_timeout();
+	CHECK(feed(&frame[4], BINARY_LINK_FRAME_SIZE - 4, &command) == 1);
+	CHECK(command.argument == 500);
+}
+
+static void test_queue(void)
+{
+	BinaryLinkCommand command;
+	
+	reset_state();
+	CHECK(binary_link_queue_pop(&command) == false);
+	
+	// One slot is kept free, so the queue holds one command less than its size
+	for (int32_t i = 0; i < BINARY_LINK_QUEUE_SIZE - 1; i++)
+	{
+		command.command = BINARY_LINK_CMD_MOVE_TO;
+		command.argument = i;
+		CHECK(binary_link_queue_push(&command));
+	}
+	CHECK(binary_link_queue_push(&command) == false);
+	CHECK(binary_link_line_errors == 1);
+	
+	// The commands come out in the order they were received
+	for (int32_t i = 0; i < BINARY_LINK_QUEUE_SIZE - 1; i++)
+	{
+		CHECK(binary_link_queue_pop(&command));
+		CHECK(command.argument == i);
+	}
+	CHECK(binary_link_queue_pop(&command) == false);
+}
+
+int main(void)
+{
+	test_crc8();
+	test_valid_frame();
+	test_wrong_crc();
+	test_resync();
+	test_timeout();
+	test_queue();
+	
+	if (failures) printf("binary_link: %d failures\n", failures);
+	else printf("binary_link: all tests passed\n");
+	
+	return failures ? 1 : 0;
+}